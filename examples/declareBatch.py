@@ -0,0 +1,96 @@
+#!/usr/bin/env python
+"""
+*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************
+"""
+from __future__ import print_function
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+import argparse
+import struct
+import binascii
+
+NATIVE_CURRENCY = "00" * 20
+
+
+def parse_bip32_path(path):
+    if len(path) == 0:
+        return b""
+    result = b""
+    elements = path.split('/')
+    for pathElement in elements:
+        element = pathElement.split('\'')
+        if len(element) == 1:
+            result = result + struct.pack(">I", int(element[0]))
+        else:
+            result = result + struct.pack(">I", 0x80000000 | int(element[0]))
+    return result
+
+
+def parse_address(address):
+    if address.startswith("0x"):
+        address = address[2:]
+    return binascii.unhexlify(address)
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--path', help="BIP 32 path the transactions are signed with")
+parser.add_argument('--count', help="Number of transactions of the batch", type=int, required=True)
+parser.add_argument('--fee-currency', help="Fee currency contract address (default : CELO)", default=NATIVE_CURRENCY)
+parser.add_argument('--max-fee', help="Maximum fee of each transaction, in the smallest unit", type=int, required=True)
+parser.add_argument('--total', help="currency:amount, total amount sent in a currency (0 for CELO), in the smallest unit",
+                    action='append', required=True)
+parser.add_argument('--to', help="Recipient address", action='append', required=True)
+parser.add_argument('--close', help="Close the current batch", action='store_true')
+args = parser.parse_args()
+
+dongle = getDongle(True)
+
+if args.close:
+    dongle.exchange(bytes(bytearray.fromhex("e010010000")))
+    exit(0)
+
+if args.path == None:
+    args.path = "44'/52752'/0'/0/0"
+
+donglePath = parse_bip32_path(args.path)
+data = struct.pack(">B", len(donglePath) // 4) + donglePath + struct.pack(">H", args.count) + parse_address(args.fee_currency) + \
+    args.max_fee.to_bytes(32, 'big') + struct.pack(">B", len(args.total))
+for total in args.total:
+    currency, amount = total.split(':')
+    if currency == "0":
+        currency = NATIVE_CURRENCY
+    data += parse_address(currency) + int(amount).to_bytes(32, 'big')
+data += struct.pack(">B", len(args.to))
+
+recipients = [parse_address(address) for address in args.to]
+p1 = 0x00
+while True:
+    # The header and the first recipients share the first chunk
+    room = (255 - len(data)) // 20
+    chunk = recipients[:room]
+    recipients = recipients[room:]
+    data += b"".join(chunk)
+    apdu = bytearray([0xe0, 0x10, p1, 0x00, len(data)]) + data
+    dongle.exchange(bytes(apdu))
+    if len(recipients) == 0:
+        break
+    data = b""
+    p1 = 0x80
+
+print("Batch approved, sign the", args.count, "transactions with signTx.py")
@@ -0,0 +1,70 @@
+#!/usr/bin/env python
+"""
+*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************
+"""
+from __future__ import print_function
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+import argparse
+import struct
+import binascii
+
+import sys
+import binascii
+
+MAX_BATCH_ADDRESSES = 12
+
+
+def parse_bip32_path(path):
+    if len(path) == 0:
+        return b""
+    result = b""
+    elements = path.split('/')
+    for pathElement in elements:
+        element = pathElement.split('\'')
+        if len(element) == 1:
+            result = result + struct.pack(">I", int(element[0]))
+        else:
+            result = result + struct.pack(">I", 0x80000000 | int(element[0]))
+    return result
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--path', help="Base BIP 32 path of the addresses")
+parser.add_argument('--start', help="First child index", type=int, default=0)
+parser.add_argument('--count', help="Number of addresses", type=int, default=20)
+args = parser.parse_args()
+
+if args.path == None:
+    args.path = "44'/52752'/0'/0"
+
+donglePath = parse_bip32_path(args.path)
+dongle = getDongle(True)
+index = args.start
+remaining = args.count
+while remaining > 0:
+    count = min(remaining, MAX_BATCH_ADDRESSES)
+    data = chr(len(donglePath) // 4).encode() + donglePath + struct.pack(">IB", index, count)
+    apdu = bytearray.fromhex("e00e0000") + chr(len(data)).encode() + data
+    result = dongle.exchange(bytes(apdu))
+    for i in range(count):
+        address = binascii.hexlify(result[20 * i: 20 * (i + 1)]).decode()
+        print("%s/%d 0x%s" % (args.path, index + i, address))
+    index += count
+    remaining -= count
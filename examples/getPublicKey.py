@@ -42,13 +42,16 @@ def parse_bip32_path(path):
 
 parser = argparse.ArgumentParser()
 parser.add_argument('--path', help="BIP 32 path to retrieve")
+parser.add_argument('--compressed', help="Return the compressed public key", action='store_true')
+parser.add_argument('--raw', help="Return the binary address", action='store_true')
 args = parser.parse_args()
 
 if args.path == None:
     args.path = "44'/52752'/0'/0/0"
 
 donglePath = parse_bip32_path(args.path)
-apdu = bytearray.fromhex("e0020100") + chr(len(donglePath) + 1).encode() + \
+p2 = (0x02 if args.compressed else 0x00) | (0x04 if args.raw else 0x00)
+apdu = bytearray.fromhex("e00201") + chr(p2).encode() + chr(len(donglePath) + 1).encode() + \
     chr(len(donglePath) // 4).encode() + donglePath
 
 dongle = getDongle(True)
@@ -57,4 +60,6 @@ offset = 1 + result[0]
 address = result[offset + 1: offset + 1 + result[offset]]
 
 print("Public key", binascii.hexlify(result[1: 1 + result[0]]).decode())
+if args.raw:
+    address = binascii.hexlify(address)
 print("Address 0x", address.decode(), sep='')
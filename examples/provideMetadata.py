@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+"""
+*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************
+"""
+from __future__ import print_function
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+import argparse
+import struct
+import binascii
+import hashlib
+
+RECORD_TOKEN = 0x00
+MAX_DEPTH = 6
+
+
+def parse_address(address):
+    if address.startswith("0x"):
+        address = address[2:]
+    return binascii.unhexlify(address)
+
+
+def sha256(data):
+    return hashlib.sha256(data).digest()
+
+
+def token_record(token):
+    ticker, address, decimals, chainId = token.split(':')
+    ticker = ticker.encode()
+    return struct.pack(">B", len(ticker)) + ticker + parse_address(address) + struct.pack(">II", int(decimals), int(chainId))
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--token', help="ticker:address:decimals:chainId, descriptor of a token", action='append', required=True)
+parser.add_argument('--signature', help="DER signature of the root, in hex. The root is printed when omitted")
+args = parser.parse_args()
+
+records = [token_record(token) for token in args.token]
+depth = 0
+while (1 << depth) < len(records):
+    depth += 1
+if depth > MAX_DEPTH:
+    parser.error("Too many tokens")
+
+# Missing leaves are zero hashes, which no record hashes to
+levels = [[sha256(struct.pack(">BB", 0x00, RECORD_TOKEN) + record) for record in records]]
+levels[0] += [b"\x00" * 32] * ((1 << depth) - len(records))
+while len(levels[-1]) > 1:
+    level = levels[-1]
+    levels.append([sha256(b"\x01" + level[i] + level[i + 1]) for i in range(0, len(level), 2)])
+root = levels[-1][0]
+
+if args.signature is None:
+    print("Root " + binascii.hexlify(root).decode())
+    print("Sign SHA-256(\"Celo metadata root\" || root) with the token key")
+    exit(0)
+
+dongle = getDongle(True)
+data = root + binascii.unhexlify(args.signature)
+dongle.exchange(bytes(bytearray([0xe0, 0x16, 0x00, 0x00, len(data)]) + data))
+
+for index, record in enumerate(records):
+    siblings = b""
+    for level in range(depth):
+        siblings += levels[level][(index >> level) ^ 1]
+    data = struct.pack(">BB", RECORD_TOKEN, len(record)) + record + struct.pack(">IB", index, depth) + siblings
+    dongle.exchange(bytes(bytearray([0xe0, 0x16, 0x01, 0x00, len(data)]) + data))
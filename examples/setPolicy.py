@@ -0,0 +1,85 @@
+#!/usr/bin/env python
+"""
+*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************
+"""
+from __future__ import print_function
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+import argparse
+import struct
+import binascii
+
+NATIVE_CURRENCY = "00" * 20
+
+
+def parse_address(address):
+    if address.startswith("0x"):
+        address = address[2:]
+    return binascii.unhexlify(address)
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--window', help="Length of the rolling window in seconds", type=int, default=86400)
+parser.add_argument('--limit', help="currency:perTransaction:perWindow, limits of a currency (0 for CELO), in the smallest unit",
+                    action='append')
+parser.add_argument('--fee-currency', help="Allowed fee currency contract address (0 for CELO)", action='append')
+parser.add_argument('--selector', help="Allowed function selector, as 4 hex bytes", action='append', default=[])
+parser.add_argument('--to', help="Recipient address", action='append')
+parser.add_argument('--disable', help="Disable the current policy", action='store_true')
+args = parser.parse_args()
+
+dongle = getDongle(True)
+
+if args.disable:
+    dongle.exchange(bytes(bytearray.fromhex("e012010000")))
+    exit(0)
+
+if not args.limit or not args.fee_currency or not args.to:
+    parser.error("--limit, --fee-currency and --to are required")
+
+data = struct.pack(">IB", args.window, len(args.limit))
+for limit in args.limit:
+    currency, perTransaction, perWindow = limit.split(':')
+    if currency == "0":
+        currency = NATIVE_CURRENCY
+    data += parse_address(currency) + int(perTransaction).to_bytes(32, 'big') + int(perWindow).to_bytes(32, 'big')
+data += struct.pack(">B", len(args.fee_currency))
+for currency in args.fee_currency:
+    data += parse_address(NATIVE_CURRENCY if currency == "0" else currency)
+data += struct.pack(">B", len(args.selector))
+for selector in args.selector:
+    data += parse_address(selector)
+data += struct.pack(">B", len(args.to))
+
+recipients = [parse_address(address) for address in args.to]
+p1 = 0x00
+while True:
+    # The header and the first recipients share the first chunk
+    room = (255 - len(data)) // 20
+    chunk = recipients[:room]
+    recipients = recipients[room:]
+    data += b"".join(chunk)
+    apdu = bytearray([0xe0, 0x12, p1, 0x00, len(data)]) + data
+    dongle.exchange(bytes(apdu))
+    if len(recipients) == 0:
+        break
+    data = b""
+    p1 = 0x80
+
+print("Policy approved")
@@ -103,7 +103,8 @@ encodedTx = encode(tx, Transaction)
 print('Encoded tx', encode_hex(encodedTx))
 
 donglePath = parse_bip32_path(args.path)
-apdu = bytearray.fromhex("e0040000")
+# P2 = 02 returns the full width v after the signature
+apdu = bytearray.fromhex("e0040002")
 apdu.append(len(donglePath) + 1 + len(encodedTx))
 apdu.append(len(donglePath) // 4)
 apdu += donglePath + encodedTx
@@ -111,12 +112,7 @@ apdu += donglePath + encodedTx
 dongle = getDongle(True)
 result = dongle.exchange(bytes(apdu))
 
-# Needs to recover (main.c:1121)
-if (CHAIN_ID*2 + 35) + 1 > 255:
-	ecc_parity = result[0] - ((CHAIN_ID*2 + 35) % 256)
-	v = (CHAIN_ID*2 + 35) + ecc_parity
-else:
-	v = result[0]
+v = struct.unpack(">I", result[1 + 32 + 32: 1 + 32 + 32 + 4])[0]
 
 r = int(binascii.hexlify(result[1:1 + 32]), 16)
 s = int(binascii.hexlify(result[1 + 32: 1 + 32 + 32]), 16)
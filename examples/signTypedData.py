@@ -0,0 +1,199 @@
+#!/usr/bin/env python
+"""
+*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************
+"""
+from __future__ import print_function
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+import argparse
+import binascii
+import json
+import re
+import struct
+
+P1_START = 0x00
+P1_STRUCT = 0x01
+P1_ARRAY = 0x02
+P1_VALUE = 0x03
+P1_END = 0x04
+P2_MORE = 0x80
+P2_DISPLAY = 0x01
+P2_ROOT = 0x01
+
+FORMAT_UINT = 0
+FORMAT_ADDRESS = 1
+FORMAT_WORD = 2
+FORMAT_STRING = 3
+FORMAT_BYTES = 4
+FORMAT_DIGEST = 5
+
+CHUNK_LENGTH = 250
+
+
+def parse_bip32_path(path):
+    if len(path) == 0:
+        return b""
+    result = b""
+    elements = path.split('/')
+    for pathElement in elements:
+        element = pathElement.split('\'')
+        if len(element) == 1:
+            result = result + struct.pack(">I", int(element[0]))
+        else:
+            result = result + struct.pack(">I", 0x80000000 | int(element[0]))
+    return result
+
+
+def referenced_types(types, name, found):
+    if name in found or name not in types:
+        return found
+    found.append(name)
+    for member in types[name]:
+        referenced_types(types, re.sub(r"\[\d*\]$", "", member["type"]), found)
+    return found
+
+
+def encode_type(types, name):
+    dependencies = referenced_types(types, name, [])[1:]
+    result = ""
+    for dependency in [name] + sorted(dependencies):
+        members = ",".join(member["type"] + " " + member["name"] for member in types[dependency])
+        result += dependency + "(" + members + ")"
+    return result.encode()
+
+
+def to_bytes(value):
+    if isinstance(value, bytes):
+        return value
+    if value.startswith("0x"):
+        return bytes.fromhex(value[2:])
+    return value.encode()
+
+
+def encode_word(kind, value):
+    if kind == "address":
+        return FORMAT_ADDRESS, bytes(12) + to_bytes(value)
+    if kind == "bool":
+        return FORMAT_WORD, int(bool(value)).to_bytes(32, "big")
+    if kind.startswith("uint"):
+        return FORMAT_UINT, int(value, 0).to_bytes(32, "big") if isinstance(value, str) else value.to_bytes(32, "big")
+    if kind.startswith("int"):
+        number = int(value, 0) if isinstance(value, str) else value
+        return FORMAT_WORD, (number % (1 << 256)).to_bytes(32, "big")
+    if kind.startswith("bytes"):
+        return FORMAT_WORD, to_bytes(value).ljust(32, b"\x00")
+    raise ValueError("Unsupported type " + kind)
+
+
+class TypedDataStreamer:
+    def __init__(self, dongle, types, shown):
+        self.dongle = dongle
+        self.types = types
+        self.shown = shown
+
+    def exchange(self, p1, p2, data=b""):
+        apdu = bytearray([0xe0, 0x14, p1, p2, len(data)]) + data
+        return self.dongle.exchange(bytes(apdu))
+
+    def chunked(self, p1, p2, data, header=b""):
+        """Sends data over several commands, the header in front of the first one"""
+        while True:
+            chunk, data = data[:CHUNK_LENGTH - len(header)], data[CHUNK_LENGTH - len(header):]
+            result = self.exchange(p1, p2 | (P2_MORE if len(data) != 0 else 0), header + chunk)
+            p2 = 0
+            header = b""
+            if len(data) == 0:
+                return result
+
+    def display(self, name):
+        """Shown values are named by their path in the message, None in arrays"""
+        return P2_DISPLAY if name is not None and name in self.shown else 0
+
+    def declared(self, members):
+        """Members shown or holding shown fields, whose names the device reads from the type string"""
+        return [index for index, (kind, value, name) in enumerate(members)
+                if name is not None and
+                any(shown == name or (kind in self.types and shown.startswith(name + ".")) for shown in self.shown)]
+
+    def nested(self, kind):
+        return re.match(r"^.*\[\d*\]$", kind) or kind in self.types or kind in ("string", "bytes")
+
+    def push(self, kind, value, name):
+        """Hashes a nested member, leaving its digest on the device stack"""
+        array = re.match(r"^(.*)\[\d*\]$", kind)
+        if array:
+            self.open(P1_ARRAY, b"", [(array.group(1), item, None) for item in value])
+            self.exchange(P1_END, 0)
+        elif kind in self.types:
+            self.struct(kind, value, name)
+        else:
+            fmt = FORMAT_STRING if kind == "string" else FORMAT_BYTES
+            self.chunked(P1_VALUE, self.display(name), to_bytes(value), bytes([fmt]))
+
+    def open(self, p1, typeString, members):
+        """Hashes the nested members last first, then opens the struct or array and sends the members"""
+        for kind, value, name in reversed(members):
+            if self.nested(kind):
+                self.push(kind, value, name)
+        if p1 == P1_STRUCT:
+            declared = self.declared(members)
+            self.chunked(P1_STRUCT, 0, typeString, bytes([len(declared)] + declared))
+        else:
+            self.exchange(P1_ARRAY, 0)
+        for kind, value, name in members:
+            if self.nested(kind):
+                self.exchange(P1_VALUE, 0, bytes([FORMAT_DIGEST]))
+            else:
+                fmt, word = encode_word(kind, value)
+                self.exchange(P1_VALUE, self.display(name), bytes([fmt]) + word)
+
+    def struct(self, name, value, path=None, root=False):
+        prefix = "" if path is None else path + "."
+        # Fields of structs in arrays are not shown
+        members = [(member["type"], value[member["name"]],
+                    None if path is None and not root else prefix + member["name"])
+                   for member in self.types[name]]
+        self.open(P1_STRUCT, encode_type(self.types, name), members)
+        return self.exchange(P1_END, P2_ROOT if root else 0)
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--path', help="BIP 32 path to sign with")
+parser.add_argument('--file', help="JSON file of the typed data (types, primaryType, domain, message)", required=True)
+parser.add_argument('--show', help="Message field shown on the device, as parent.child for nested ones",
+                    action='append', default=[])
+args = parser.parse_args()
+
+if args.path == None:
+    args.path = "44'/52752'/0'/0/0"
+
+with open(args.file) as f:
+    typedData = json.load(f)
+
+dongle = getDongle(True)
+donglePath = parse_bip32_path(args.path)
+streamer = TypedDataStreamer(dongle, typedData["types"], [])
+streamer.exchange(P1_START, 0x00, struct.pack(">B", len(donglePath) // 4) + donglePath)
+streamer.struct("EIP712Domain", typedData["domain"], root=True)
+streamer.shown = args.show
+result = streamer.struct(typedData["primaryType"], typedData["message"], root=True)
+
+print("v", result[0])
+print("r", binascii.hexlify(result[1:1 + 32]).decode())
+print("s", binascii.hexlify(result[1 + 32: 1 + 32 + 32]).decode())
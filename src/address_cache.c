@@ -0,0 +1,57 @@
+#include "address_cache.h"
+
+#include "ethUtils.h"
+#include "globals.h"
+
+#include <string.h>
+
+typedef struct addressCacheEntry_t {
+  uint8_t address[20];
+  char string[40];
+} addressCacheEntry_t;
+
+// Most recently used first, only the first count entries are valid
+static addressCacheEntry_t addressCache[ADDRESS_CACHE_SIZE];
+static uint8_t addressCacheCount;
+
+addressCacheStats_t addressCacheStats;
+
+// Moves the entry of address to the front of the cache, computing it on a miss
+static void lookupAddress(const uint8_t *address) {
+  addressCacheEntry_t entry;
+  uint8_t i;
+  for (i = 0; i < addressCacheCount; i++) {
+    if (memcmp(addressCache[i].address, address, 20) == 0) {
+      break;
+    }
+  }
+  if (i < addressCacheCount) {
+    addressCacheStats.hits++;
+    entry = addressCache[i];
+  }
+  else {
+    char string[41];
+    cx_sha3_t addressSha3;
+    addressCacheStats.misses++;
+    getEthAddressStringFromBinary(address, string, CHAIN_ID, &addressSha3);
+    memcpy(entry.address, address, 20);
+    memcpy(entry.string, string, 40);
+    // Evicts the least recently used entry when full
+    if (addressCacheCount < ADDRESS_CACHE_SIZE) {
+      addressCacheCount++;
+    }
+    i = addressCacheCount - 1;
+  }
+  memmove(addressCache + 1, addressCache, i * sizeof(addressCacheEntry_t));
+  addressCache[0] = entry;
+}
+
+void getCachedAddressString(const uint8_t *address, char *out) {
+  lookupAddress(address);
+  memcpy(out, addressCache[0].string, 40);
+  out[40] = '\0';
+}
+
+void prefetchAddressString(const uint8_t *address) {
+  lookupAddress(address);
+}
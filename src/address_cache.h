@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "cx.h"
+
+// Number of checksummed address strings kept in RAM
+#ifndef ADDRESS_CACHE_SIZE
+#define ADDRESS_CACHE_SIZE 4
+#endif
+
+typedef struct addressCacheStats_t {
+  uint32_t hits;
+  uint32_t misses;
+} addressCacheStats_t;
+
+extern addressCacheStats_t addressCacheStats;
+
+// Writes the 40 characters checksummed string of a 20 bytes address followed
+// by a terminating zero, from the cache when the address was seen recently.
+// The checksum is hashed on the stack, so this can be called while a
+// transaction hash is being computed.
+void getCachedAddressString(const uint8_t *address, char *out);
+
+// Computes the checksummed string of an address ahead of its display
+void prefetchAddressString(const uint8_t *address);
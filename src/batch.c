@@ -0,0 +1,266 @@
+#include "batch.h"
+
+#include "os.h"
+#include "ux.h"
+
+#include "address_cache.h"
+#include "celo.h"
+#include "globals.h"
+#include "ui_flow.h"
+#include "uint256.h"
+#include "utils.h"
+
+#include <string.h>
+
+#define P1_BATCH_FIRST 0x00
+#define P1_BATCH_MORE 0x80
+#define P1_BATCH_CLOSE 0x01
+
+typedef enum {
+  BATCH_IDLE,
+  // Waiting for the rest of the recipients, or for the user approval
+  BATCH_DECLARING,
+  BATCH_APPROVED
+} batchState_e;
+
+typedef struct batchCurrency_t {
+  // Zero for the native currency
+  uint8_t token[20];
+  char ticker[10];
+  uint8_t decimals;
+  uint256_t remaining;
+} batchCurrency_t;
+
+typedef struct batchContext_t {
+  uint8_t state;
+  // Account the batch is signed with
+  bip32Path_t derivationPath;
+  uint16_t remainingTransactions;
+  uint8_t feeCurrency[20];
+  char feeTicker[10];
+  uint8_t feeDecimals;
+  uint256_t maxFee;
+  uint8_t currencyCount;
+  batchCurrency_t currencies[BATCH_MAX_CURRENCIES];
+  uint8_t destinationCount;
+  uint8_t receivedDestinations;
+  uint8_t destinations[BATCH_MAX_DESTINATIONS][20];
+  // Currency total and recipient shown in the review
+  uint8_t totalIndex;
+  uint8_t recipientIndex;
+} batchContext_t;
+
+// Kept apart from tmpCtx, which the signed transactions reuse
+static batchContext_t batch;
+
+void formatBatchField(batchField_e field) {
+  char *out = strings.common.display;
+  size_t outLength = sizeof(strings.common.display);
+  int offset;
+
+  switch (field) {
+    case BATCH_FIELD_COUNT:
+      snprintf(out, outLength, "%d", batch.remainingTransactions);
+      break;
+    case BATCH_FIELD_TOTAL:
+      offset = snprintf(out, outLength, "%d/%d ", batch.totalIndex + 1, batch.currencyCount);
+      amountToString(&batch.currencies[batch.totalIndex].remaining,
+                     batch.currencies[batch.totalIndex].ticker,
+                     batch.currencies[batch.totalIndex].decimals,
+                     out + offset, outLength - offset);
+      break;
+    case BATCH_FIELD_MAX_FEE:
+      amountToString(&batch.maxFee, batch.feeTicker, batch.feeDecimals, out, outLength);
+      break;
+    case BATCH_FIELD_RECIPIENT:
+      offset = snprintf(out, outLength, "%d/%d 0x", batch.recipientIndex + 1, batch.destinationCount);
+      getCachedAddressString(batch.destinations[batch.recipientIndex], out + offset);
+      break;
+  }
+}
+
+void batchNextTotal(void) {
+  batch.totalIndex = (batch.totalIndex + 1) % batch.currencyCount;
+  ux_flow_relayout();
+}
+
+void batchNextRecipient(void) {
+  batch.recipientIndex = (batch.recipientIndex + 1) % batch.destinationCount;
+  ux_flow_relayout();
+}
+
+bool batchActive(void) {
+  return (batch.state == BATCH_APPROVED);
+}
+
+void batchClose(void) {
+  explicit_bzero(&batch, sizeof(batch));
+}
+
+void batchApprove(void) {
+  batch.state = BATCH_APPROVED;
+}
+
+// Checks that the envelope can be displayed, the amounts are rendered at
+// review time
+static bool envelopeFits(void) {
+  char text[sizeof(strings.common.display)];
+  // Room for the "i/n " index prefix of the totals
+  const size_t totalLength = sizeof(text) - 4;
+  for (uint8_t i = 0; i < batch.currencyCount; i++) {
+    if (!amountToString(&batch.currencies[i].remaining, batch.currencies[i].ticker,
+                        batch.currencies[i].decimals, text, totalLength)) {
+      return false;
+    }
+  }
+  return amountToString(&batch.maxFee, batch.feeTicker, batch.feeDecimals, text, sizeof(text));
+}
+
+static void parseHeader(const uint8_t *workBuffer, uint16_t dataLength, uint16_t *offset) {
+  const uint8_t *header;
+  uint16_t headerLength;
+  if (parse_bip32_path(&batch.derivationPath, workBuffer, dataLength)) {
+    PRINTF("Invalid path\n");
+    THROW(0x6A80);
+  }
+  header = workBuffer + 1 + batch.derivationPath.len * sizeof(uint32_t);
+  headerLength = (header - workBuffer) + 2 + 20 + 32 + 1;
+  if (dataLength < headerLength) {
+    THROW(0x6700);
+  }
+  batch.remainingTransactions = U2BE(header, 0);
+  memcpy(batch.feeCurrency, header + 2, 20);
+  readu256BE(header + 2 + 20, &batch.maxFee);
+  batch.currencyCount = header[2 + 20 + 32];
+  if ((batch.remainingTransactions == 0) || (batch.currencyCount == 0) ||
+      (batch.currencyCount > BATCH_MAX_CURRENCIES)) {
+    THROW(0x6A80);
+  }
+  if (!lookupCurrency(batch.feeCurrency, batch.feeTicker, &batch.feeDecimals)) {
+    PRINTF("Unknown fee currency\n");
+    THROW(0x6A80);
+  }
+  *offset = headerLength;
+  for (uint8_t i = 0; i < batch.currencyCount; i++) {
+    batchCurrency_t *currency = &batch.currencies[i];
+    if (dataLength < *offset + 20 + 32) {
+      THROW(0x6700);
+    }
+    memcpy(currency->token, workBuffer + *offset, 20);
+    readu256BE(workBuffer + *offset + 20, &currency->remaining);
+    *offset += 20 + 32;
+    if (!lookupCurrency(currency->token, currency->ticker, &currency->decimals)) {
+      PRINTF("Unknown currency\n");
+      THROW(0x6A80);
+    }
+    for (uint8_t j = 0; j < i; j++) {
+      if (memcmp(batch.currencies[j].token, currency->token, 20) == 0) {
+        THROW(0x6A80);
+      }
+    }
+  }
+  if (dataLength < *offset + 1) {
+    THROW(0x6700);
+  }
+  batch.destinationCount = workBuffer[(*offset)++];
+  if ((batch.destinationCount == 0) || (batch.destinationCount > BATCH_MAX_DESTINATIONS)) {
+    THROW(0x6A80);
+  }
+}
+
+void handleDeclareBatch(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx) {
+  UNUSED(tx);
+  uint16_t offset = 0;
+  uint8_t count;
+
+  if (p2 != 0) {
+    THROW(0x6B00);
+  }
+  switch (p1) {
+    case P1_BATCH_CLOSE:
+      batchClose();
+      THROW(0x9000);
+    case P1_BATCH_FIRST:
+      batchClose();
+      // The state stays idle if the header is rejected
+      parseHeader(workBuffer, dataLength, &offset);
+      batch.state = BATCH_DECLARING;
+      break;
+    case P1_BATCH_MORE:
+      if ((batch.state != BATCH_DECLARING) || (batch.receivedDestinations == batch.destinationCount)) {
+        THROW(0x6985);
+      }
+      break;
+    default:
+      THROW(0x6B00);
+  }
+
+  count = (dataLength - offset) / 20;
+  if ((count * 20 != dataLength - offset) ||
+      (batch.receivedDestinations + count > batch.destinationCount)) {
+    batchClose();
+    THROW(0x6A80);
+  }
+  memcpy(batch.destinations[batch.receivedDestinations], workBuffer + offset, count * 20);
+  batch.receivedDestinations += count;
+  if (batch.receivedDestinations < batch.destinationCount) {
+    THROW(0x9000);
+  }
+
+  if (!envelopeFits()) {
+    batchClose();
+    PRINTF("Amount too large to display\n");
+    THROW(0x6A80);
+  }
+  batch.totalIndex = 0;
+  batch.recipientIndex = 0;
+  ux_flow_init(0, ux_approval_batch_flow, NULL);
+  *flags |= IO_ASYNCH_REPLY;
+}
+
+static batchCurrency_t *findCurrency(const uint8_t *token) {
+  for (uint8_t i = 0; i < batch.currencyCount; i++) {
+    if (memcmp(batch.currencies[i].token, token, 20) == 0) {
+      return &batch.currencies[i];
+    }
+  }
+  return NULL;
+}
+
+static bool isDestination(const uint8_t *address) {
+  for (uint8_t i = 0; i < batch.destinationCount; i++) {
+    if (memcmp(batch.destinations[i], address, 20) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool batchAuthorize(void) {
+  const txContent_t *content = &tmpContent.txContent;
+  const tokenDefinition_t *token = tmpCtx.transactionContext.amountToken;
+  const uint8_t *feeCurrency = (content->feeCurrencyLength != 0 ? content->feeCurrency : NATIVE_CURRENCY);
+  batchCurrency_t *currency = findCurrency(token != NULL ? token->address : NATIVE_CURRENCY);
+  uint256_t fee, value;
+
+  convertUint256BE(content->value.value, content->value.length, &value);
+  if (!batchActive() || dataPresent || (content->destinationLength == 0) ||
+      (tmpCtx.transactionContext.derivationPath.len != batch.derivationPath.len) ||
+      (memcmp(tmpCtx.transactionContext.derivationPath.path, batch.derivationPath.path,
+              batch.derivationPath.len * sizeof(uint32_t)) != 0) ||
+      (currency == NULL) || !isDestination(content->destination) ||
+      // The gateway fee goes to the gateway destination
+      ((content->gatewayDestinationLength != 0) && !isDestination(content->gatewayDestination)) ||
+      (memcmp(feeCurrency, batch.feeCurrency, 20) != 0) ||
+      !getMaxFee(content, &fee) || gt256(&fee, &batch.maxFee) ||
+      gt256(&value, &currency->remaining)) {
+    PRINTF("Transaction outside of the batch\n");
+    batchClose();
+    return false;
+  }
+  minus256(&currency->remaining, &value, &currency->remaining);
+  if (--batch.remainingTransactions == 0) {
+    batchClose();
+  }
+  return true;
+}
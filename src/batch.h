@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Batch signing: the host declares an envelope (number of transactions,
+// total amount per currency, maximum fee and recipients), the user approves
+// it once, and the transactions signed next are checked against it instead
+// of being reviewed one by one.
+
+#ifndef BATCH_MAX_CURRENCIES
+#define BATCH_MAX_CURRENCIES 2
+#endif
+
+#ifndef BATCH_MAX_DESTINATIONS
+#define BATCH_MAX_DESTINATIONS 8
+#endif
+
+typedef enum {
+  BATCH_FIELD_COUNT,
+  BATCH_FIELD_TOTAL,
+  BATCH_FIELD_MAX_FEE,
+  BATCH_FIELD_RECIPIENT
+} batchField_e;
+
+void handleDeclareBatch(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx);
+
+// True once an envelope was approved and until all its transactions are
+// signed
+bool batchActive(void);
+
+// Checks the parsed transaction against the approved envelope, and charges
+// it to the envelope if it fits. The batch is closed otherwise.
+bool batchAuthorize(void);
+
+// Ends the batch, on user rejection, exit or lock
+void batchClose(void);
+
+// Renders a screen of the envelope review into strings.common
+void formatBatchField(batchField_e field);
+// Shows the next currency total, or the next recipient
+void batchNextTotal(void);
+void batchNextRecipient(void);
+
+// Called when the user approves the envelope
+void batchApprove(void);
@@ -0,0 +1,43 @@
+#include "bip32.h"
+
+#include "os.h"
+#include "cx.h"
+
+#include <string.h>
+
+static const uint8_t SECP256K1_ORDER[32] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xfe, 0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48,
+  0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41
+};
+
+void bip32GetCompressedPublicKey(const uint8_t *privateKey, uint8_t *out) {
+  cx_ecfp_private_key_t key;
+  cx_ecfp_public_key_t publicKey;
+  cx_ecfp_init_private_key(CX_CURVE_256K1, privateKey, 32, &key);
+  cx_ecfp_generate_pair(CX_CURVE_256K1, &publicKey, &key, 1);
+  explicit_bzero(&key, sizeof(key));
+  out[0] = 0x02 | (publicKey.W[64] & 0x01);
+  memcpy(out + 1, publicKey.W + 1, 32);
+}
+
+bool bip32DeriveChild(uint8_t *privateKey, uint8_t *chainCode, const uint8_t *publicKey, uint32_t index) {
+  uint8_t data[33 + 4];
+  uint8_t digest[64];
+  bool valid;
+
+  memcpy(data, publicKey, 33);
+  data[33] = (index >> 24) & 0xff;
+  data[34] = (index >> 16) & 0xff;
+  data[35] = (index >> 8) & 0xff;
+  data[36] = index & 0xff;
+  cx_hmac_sha512(chainCode, 32, data, sizeof(data), digest, sizeof(digest));
+  // The left half must be a valid scalar, and the child key non zero
+  valid = (cx_math_cmp(digest, SECP256K1_ORDER, 32) < 0);
+  cx_math_addm(digest, digest, privateKey, SECP256K1_ORDER, 32);
+  valid = valid && !cx_math_is_zero(digest, 32);
+  memcpy(privateKey, digest, 32);
+  memcpy(chainCode, digest + 32, 32);
+  explicit_bzero(digest, sizeof(digest));
+  return valid;
+}
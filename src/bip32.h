@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BIP32_HARDENED 0x80000000
+
+// Compressed (33 bytes) secp256k1 public key of a private key
+void bip32GetCompressedPublicKey(const uint8_t *privateKey, uint8_t *out);
+
+// Replaces the node (privateKey, chainCode) by its non hardened child index,
+// given the compressed public key of the node (BIP32 CKDpriv). Returns false
+// if the child key is invalid, in which case the node is left undefined.
+bool bip32DeriveChild(uint8_t *privateKey, uint8_t *chainCode, const uint8_t *publicKey, uint32_t index);
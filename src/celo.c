@@ -1,5 +1,14 @@
 #include "celo.h"
+#include "address_cache.h"
+#include "batch.h"
+#include "eip712.h"
+#include "policy.h"
+#include "signature_cache.h"
+#include "tokenCache.h"
+#include "token_registry.h"
+#include "tokensList.h"
 #include "ethUtils.h"
+#include "hexUtils.h"
 #include "globals.h"
 #include "os.h"
 #include "utils.h"
@@ -39,15 +48,62 @@ void format_signature_out(const uint8_t* signature) {
   memmove(G_io_apdu_buffer+offset+32-xlength, signature+xoffset, xlength);
 }
 
+uint8_t get_recovery_id(unsigned int info) {
+  uint8_t recoveryId = 0;
+  if (info & CX_ECCINFO_PARITY_ODD) {
+    recoveryId++;
+  }
+  if (info & CX_ECCINFO_xGTn) {
+    recoveryId += 2;
+  }
+  return recoveryId;
+}
+
+void send_signature_out(uint8_t recoveryId, uint32_t v, uint8_t flags) {
+  uint32_t tx = SIGNATURE_RESPONSE_LENGTH;
+  // Truncated for a large v, the full value is sent with P2_FULL_V
+  G_io_apdu_buffer[0] = (uint8_t)v;
+  if (flags & P2_RECOVERY_ID) {
+    G_io_apdu_buffer[tx++] = recoveryId;
+  }
+  if (flags & P2_FULL_V) {
+    G_io_apdu_buffer[tx++] = (v >> 24) & 0xff;
+    G_io_apdu_buffer[tx++] = (v >> 16) & 0xff;
+    G_io_apdu_buffer[tx++] = (v >> 8) & 0xff;
+    G_io_apdu_buffer[tx++] = v & 0xff;
+  }
+  G_io_apdu_buffer[tx++] = 0x90;
+  G_io_apdu_buffer[tx++] = 0x00;
+  reset_app_context();
+  // Send back the response, do not restart the event loop
+  io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
+}
+
 uint32_t set_result_get_publicKey() {
     uint32_t tx = 0;
-    G_io_apdu_buffer[tx++] = 65;
-    memcpy(G_io_apdu_buffer + tx, tmpCtx.publicKeyContext.publicKey.W, 65);
-    tx += 65;
-    G_io_apdu_buffer[tx++] = 40;
-    memcpy(G_io_apdu_buffer + tx, tmpCtx.publicKeyContext.address, 40);
-    tx += 40;
-    if (tmpCtx.publicKeyContext.getChaincode) {
+    uint8_t flags = tmpCtx.publicKeyContext.responseFlags;
+    if (flags & P2_COMPRESSED_KEY) {
+      G_io_apdu_buffer[tx++] = 33;
+      G_io_apdu_buffer[tx++] = 0x02 | (tmpCtx.publicKeyContext.publicKey.W[64] & 0x01);
+      memcpy(G_io_apdu_buffer + tx, tmpCtx.publicKeyContext.publicKey.W + 1, 32);
+      tx += 32;
+    }
+    else {
+      G_io_apdu_buffer[tx++] = 65;
+      memcpy(G_io_apdu_buffer + tx, tmpCtx.publicKeyContext.publicKey.W, 65);
+      tx += 65;
+    }
+    if (flags & P2_RAW_ADDRESS) {
+      G_io_apdu_buffer[tx++] = 20;
+      memcpy(G_io_apdu_buffer + tx, tmpCtx.publicKeyContext.rawAddress, 20);
+      tx += 20;
+    }
+    else if (!(flags & P2_KEY_ONLY)) {
+      G_io_apdu_buffer[tx++] = 40;
+      memcpy(G_io_apdu_buffer + tx, tmpCtx.publicKeyContext.address, 40);
+      tx += 40;
+    }
+    if (flags & P2_CHAINCODE) {
       memcpy(G_io_apdu_buffer + tx, tmpCtx.publicKeyContext.chainCode, 32);
       tx += 32;
     }
@@ -57,29 +113,60 @@ uint32_t set_result_get_publicKey() {
 volatile uint8_t appState;
 
 void reset_app_context() {
+  // Every error resets the context, an aborted typed data signature must not
+  // leave fields behind
+  if (appState == APP_STATE_SIGNING_TYPED_DATA) {
+    typedDataInit();
+  }
   appState = APP_STATE_IDLE;
   PRINTF("Resetting context\n");
-  memset(tmpCtx.transactionContext.tokenSet, 0, MAX_TOKEN);
   memset(&txContext, 0, sizeof(txContext));
   memset(&tmpContent, 0, sizeof(tmpContent));
 }
 
-#include "uint256.h"
-
 #define WEI_TO_ETHER 18
 
+// Significant digits of the amounts in compact mode
+#ifndef COMPACT_AMOUNT_DIGITS
+#define COMPACT_AMOUNT_DIGITS 8
+#endif
+
 tokenDefinition_t* getKnownToken(uint8_t *tokenAddr) {
     tokenDefinition_t *currentToken = NULL;
 
-    for(int i=0; i < MAX_TOKEN; i++) {
-      currentToken = &tmpCtx.transactionContext.tokens[i];
-      if (tmpCtx.transactionContext.tokenSet[i] && (memcmp(currentToken->address, tokenAddr, 20) == 0)) {
-        PRINTF("Token found at index %d\n", i);
-        return currentToken;
-      }
+#ifdef HAVE_BUILTIN_TOKENS
+    currentToken = (tokenDefinition_t *)getBuiltinToken(tokenAddr);
+    if (currentToken != NULL) {
+      return currentToken;
     }
+#endif
 
-    return NULL;
+    currentToken = lookupCachedToken(tokenAddr);
+    if (currentToken != NULL) {
+      return currentToken;
+    }
+
+    // Tokens verified in an earlier session need not be provided again, and
+    // are cached to spare the next lookups the NVM scan
+    const tokenDefinition_t *registered = lookupRegisteredToken(tokenAddr);
+    return (registered != NULL ? cacheToken(registered) : NULL);
+}
+
+const uint8_t NATIVE_CURRENCY[20] = { 0 };
+
+bool lookupCurrency(const uint8_t *token, char *ticker, uint8_t *decimals) {
+  if (memcmp(token, NATIVE_CURRENCY, 20) == 0) {
+    strcpy(ticker, CHAINID_COINNAME " ");
+    *decimals = WEI_TO_ETHER;
+    return true;
+  }
+  tokenDefinition_t *definition = getKnownToken((uint8_t *)token);
+  if (definition == NULL) {
+    return false;
+  }
+  strcpy(ticker, definition->ticker);
+  *decimals = definition->decimals;
+  return true;
 }
 
 static uint32_t splitBinaryParameterPart(char *result, uint8_t *parameter) {
@@ -96,12 +183,133 @@ static uint32_t splitBinaryParameterPart(char *result, uint8_t *parameter) {
         return 2;
     }
     else {
-        array_hexstr(result, parameter + i, 8 - i);
+        hexEncode(parameter + i, 8 - i, result);
         return ((8 - i) * 2);
     }
 }
 
+static bool getFeeCurrency(const char **ticker, uint8_t *decimals) {
+  *ticker = CHAINID_COINNAME " ";
+  *decimals = WEI_TO_ETHER;
+  // Display correct currency if fee currency field sent
+  if (tmpContent.txContent.feeCurrencyLength != 0) {
+    tokenDefinition_t *feeCurrencyToken = getKnownToken(tmpContent.txContent.feeCurrency);
+    if (feeCurrencyToken == NULL) {
+      return false;
+    }
+    *ticker = (const char *)feeCurrencyToken->ticker;
+    *decimals = feeCurrencyToken->decimals;
+  }
+  return true;
+}
+
+static bool formatAmount(const char *ticker, uint8_t decimals, const char *digits, char *out, size_t outLength) {
+  size_t tickerLength = strlen(ticker);
+  if (tickerLength + 1 >= outLength) {
+    return false;
+  }
+  memcpy(out, ticker, tickerLength);
+  if (!N_storage.compactAmounts || reviewExactAmounts) {
+    return adjustDecimals(digits, strlen(digits), out + tickerLength, outLength - tickerLength, decimals);
+  }
+  // Compact amounts fit one screen, a leading ~ marks a truncated value
+  out[tickerLength] = '~';
+  if (!adjustDecimals(digits, strlen(digits), out + tickerLength + 1, outLength - tickerLength - 1, decimals)) {
+    return false;
+  }
+  if (!truncateDecimals(out + tickerLength + 1, COMPACT_AMOUNT_DIGITS)) {
+    memmove(out + tickerLength, out + tickerLength + 1, strlen(out + tickerLength + 1) + 1);
+  }
+  return true;
+}
+
+// Checks that an amount of at most the given number of bits can be rendered
+// into strings.common, without rendering it
+static bool amountFits(uint32_t bits, const char *ticker, uint8_t decimals) {
+  // Decimal digits of a value below 2^bits, 1234 / 4096 is just above log10(2)
+  uint32_t digits = ((bits * 1234) >> 12) + 1;
+  // Terminating zero and compact mode marker
+  uint32_t length = strlen(ticker) + 2;
+  if (digits <= decimals) {
+    // 0.000ddd
+    length += decimals + 2;
+  }
+  else {
+    length += digits + 1;
+  }
+  return (length <= sizeof(strings.common.display));
+}
+
+static void formatAddress(const uint8_t *address, char *out) {
+  out[0] = '0';
+  out[1] = 'x';
+  getCachedAddressString(address, out + 2);
+}
+
+// Computes the address checksums once their field is parsed, so that the
+// Keccak work is done while the rest of the transaction is streamed
+static void prefetchAddresses(rlpTxField_e currentField) {
+  txContent_t *content = &tmpContent.txContent;
+  if ((currentField > TX_RLP_GATEWAYTO) && ((prefetchedAddresses & PREFETCHED_GATEWAY_ADDRESS) == 0)) {
+    if (content->gatewayDestinationLength != 0) {
+      prefetchAddressString(content->gatewayDestination);
+    }
+    prefetchedAddresses |= PREFETCHED_GATEWAY_ADDRESS;
+  }
+  if ((currentField > TX_RLP_TO) && ((prefetchedAddresses & PREFETCHED_ADDRESS) == 0)) {
+    if (content->destinationLength != 0) {
+      prefetchAddressString(content->destination);
+    }
+    prefetchedAddresses |= PREFETCHED_ADDRESS;
+  }
+}
+
+void formatReviewField(reviewField_e field) {
+  // Enough for 2^256 in decimal
+  char digits[80];
+  const char *ticker = CHAINID_COINNAME " ";
+  uint8_t decimals = WEI_TO_ETHER;
+  txContent_t *content = &tmpContent.txContent;
+  char *out = strings.common.display;
+
+  // Everything was validated by finalizeParsing
+  switch (field) {
+    case REVIEW_AMOUNT:
+      if (tmpCtx.transactionContext.amountToken != NULL) {
+        ticker = tmpCtx.transactionContext.amountToken->ticker;
+        decimals = tmpCtx.transactionContext.amountToken->decimals;
+      }
+      txIntToString(content->value.value, content->value.length, digits, sizeof(digits));
+      formatAmount(ticker, decimals, digits, out, sizeof(strings.common.display));
+      break;
+    case REVIEW_ADDRESS:
+      if (content->destinationLength != 0) {
+        formatAddress(content->destination, out);
+      }
+      else {
+        strcpy(out, "New Contract");
+      }
+      break;
+    case REVIEW_MAX_FEE:
+      getFeeCurrency(&ticker, &decimals);
+      txIntProductToString(content->gasprice.value, content->gasprice.length,
+                           content->startgas.value, content->startgas.length,
+                           digits, sizeof(digits));
+      formatAmount(ticker, decimals, digits, out, sizeof(strings.common.display));
+      break;
+    case REVIEW_GATEWAY_FEE:
+      getFeeCurrency(&ticker, &decimals);
+      txIntToString(content->gatewayFee.value, content->gatewayFee.length, digits, sizeof(digits));
+      formatAmount(ticker, decimals, digits, out, sizeof(strings.common.display));
+      break;
+    case REVIEW_GATEWAY_ADDRESS:
+      formatAddress(content->gatewayDestination, out);
+      break;
+  }
+}
+
 customStatus_e customProcessor(txContext_t *context) {
+    prefetchAddresses(context->currentField);
     if ((context->currentField == TX_RLP_DATA) &&
         (context->currentFieldLength != 0)) {
         dataPresent = true;
@@ -115,6 +323,7 @@ customStatus_e customProcessor(txContext_t *context) {
                 PRINTF("Missing function selector\n");
                 return CUSTOM_FAULT;
             }
+            memcpy(tmpCtx.transactionContext.selector, context->workBuffer, 4);
             // Initial check to see if the token content can be processed
             tokenProvisioned =
                 (context->currentFieldLength == sizeof(dataContext.tokenContext.data)) &&
@@ -187,7 +396,7 @@ customStatus_e customProcessor(txContext_t *context) {
                 }
                 dataContext.rawDataContext.fieldOffset = 0;
                 if (fieldPos == 0) {
-                    array_hexstr(strings.tmp.tmp, dataContext.rawDataContext.data, 4);
+                    hexEncode(dataContext.rawDataContext.data, 4, strings.tmp.tmp);
                     ux_flow_init(0, ux_confirm_selector_flow, NULL);
                 }
                 else {
@@ -214,36 +423,40 @@ customStatus_e customProcessor(txContext_t *context) {
 }
 
 void finalizeParsing(bool direct) {
-  uint256_t gasPrice, startGas, uint256;
-  uint32_t i;
   uint8_t decimals = WEI_TO_ETHER;
-  uint8_t feeDecimals = WEI_TO_ETHER;
   char *ticker = CHAINID_COINNAME " ";
-  char *feeTicker = CHAINID_COINNAME " ";
-  uint8_t tickerOffset = 0;
+  const char *feeTicker;
+  uint8_t feeDecimals;
+  uint32_t gasBits;
+  uint8_t recoveryId;
 
-  // Display correct currency if fee currency field sent
-  if (tmpContent.txContent.feeCurrencyLength != 0) {
-    tokenDefinition_t *feeCurrencyToken = getKnownToken(tmpContent.txContent.feeCurrency);
-    if (feeCurrencyToken == NULL) {
-      reset_app_context();
-      PRINTF("Invalid fee currency");
-      if (direct) {
-          THROW(0x6A80);
-      }
-      else {
-          io_seproxyhal_send_status(0x6A80);
-          ui_idle();
-          return;
-      }
-    } else {
-      feeTicker = feeCurrencyToken->ticker;
-      feeDecimals = feeCurrencyToken->decimals;
+  tmpCtx.transactionContext.amountToken = NULL;
+
+  if (!getFeeCurrency(&feeTicker, &feeDecimals)) {
+    reset_app_context();
+    PRINTF("Invalid fee currency");
+    if (direct) {
+        THROW(0x6A80);
+    }
+    else {
+        io_seproxyhal_send_status(0x6A80);
+        ui_idle();
+        return;
     }
   }
 
   // Store the hash
   cx_hash((cx_hash_t *)&sha3, CX_LAST, tmpCtx.transactionContext.hash, 0, tmpCtx.transactionContext.hash, 32);
+
+  // A transaction resent after the link dropped is answered with the
+  // signature already approved
+  if (lookupSignature(&tmpCtx.transactionContext.derivationPath, tmpCtx.transactionContext.hash,
+                      G_io_apdu_buffer + 1, &recoveryId)) {
+    send_signature_out(recoveryId, getSignatureV(&tmpContent.txContent, recoveryId),
+                       tmpCtx.transactionContext.responseFlags);
+    ui_idle();
+    return;
+  }
     // If there is a token to process, check if it is well known
     if (tokenProvisioned) {
         tokenDefinition_t *currentToken = getKnownToken(tmpContent.txContent.destination);
@@ -255,6 +468,7 @@ void finalizeParsing(bool direct) {
             memcpy(tmpContent.txContent.destination, dataContext.tokenContext.data + 4 + 12, 20);
             memcpy(tmpContent.txContent.value.value, dataContext.tokenContext.data + 4 + 32, 32);
             tmpContent.txContent.value.length = 32;
+            tmpCtx.transactionContext.amountToken = currentToken;
         }
     }
     else {
@@ -271,87 +485,47 @@ void finalizeParsing(bool direct) {
           }
       }
     }
-  // Add address
-  if (tmpContent.txContent.destinationLength != 0) {
-    char address[41];
-    getEthAddressStringFromBinary(tmpContent.txContent.destination, address, CHAIN_ID, &sha3);
-    strings.common.fullAddress[0] = '0';
-    strings.common.fullAddress[1] = 'x';
-    memcpy(strings.common.fullAddress+2, address, 40);
-    strings.common.fullAddress[42] = '\0';
-  }
-  else
-  {
-    strcpy(strings.common.fullAddress, "New Contract");
-  }
-  // Add gateway fee recipient address
-  if (tmpContent.txContent.gatewayDestinationLength != 0) {
-    char gatewayAddress[41];
-    getEthAddressStringFromBinary(tmpContent.txContent.gatewayDestination, gatewayAddress, CHAIN_ID, &sha3);
-    strings.common.fullGatewayAddress[0] = '0';
-    strings.common.fullGatewayAddress[1] = 'x';
-    memcpy(strings.common.fullGatewayAddress+2, gatewayAddress, 40);
-    strings.common.fullGatewayAddress[42] = '\0';
-  }
-  // Add amount in ethers or tokens
-  convertUint256BE(tmpContent.txContent.value.value, tmpContent.txContent.value.length, &uint256);
-  tostring256(&uint256, 10, (char *)(G_io_apdu_buffer + 100), 100);
-  i = 0;
-  while (G_io_apdu_buffer[100 + i]) {
-    i++;
-  }
-  adjustDecimals((char *)(G_io_apdu_buffer + 100), i, (char *)G_io_apdu_buffer, 100, decimals);
-  i = 0;
-    tickerOffset = 0;
-    while (ticker[tickerOffset]) {
-        strings.common.fullAmount[tickerOffset] = ticker[tickerOffset];
-        tickerOffset++;
+  // The review strings are rendered when displayed, only check that they fit
+  gasBits = txIntBits(tmpContent.txContent.gasprice.value, tmpContent.txContent.gasprice.length) +
+            txIntBits(tmpContent.txContent.startgas.value, tmpContent.txContent.startgas.length);
+  if (!amountFits(txIntBits(tmpContent.txContent.value.value, tmpContent.txContent.value.length), ticker, decimals) ||
+      !amountFits(txIntBits(tmpContent.txContent.gatewayFee.value, tmpContent.txContent.gatewayFee.length), feeTicker, feeDecimals) ||
+      !amountFits((gasBits < 256 ? gasBits : 256), feeTicker, feeDecimals)) {
+    reset_app_context();
+    PRINTF("Amount too large to display\n");
+    if (direct) {
+      THROW(0x6A80);
     }
-    while (G_io_apdu_buffer[i]) {
-        strings.common.fullAmount[tickerOffset + i] = G_io_apdu_buffer[i];
-        i++;
+    else {
+      io_seproxyhal_send_status(0x6A80);
+      ui_idle();
+      return;
     }
-  strings.common.fullAmount[tickerOffset + i] = '\0';
-  // Add gateway fee
-  convertUint256BE(tmpContent.txContent.gatewayFee.value, tmpContent.txContent.gatewayFee.length, &uint256);
-  tostring256(&uint256, 10, (char *)(G_io_apdu_buffer + 100), 100);
-  i = 0;
-  while (G_io_apdu_buffer[100 + i]) {
-    i++;
   }
-  adjustDecimals((char *)(G_io_apdu_buffer + 100), i, (char *)G_io_apdu_buffer, 100, feeDecimals);
-  i = 0;
-    tickerOffset = 0;
-    while (feeTicker[tickerOffset]) {
-        strings.common.gatewayFee[tickerOffset] = feeTicker[tickerOffset];
-        tickerOffset++;
-    }
-    while (G_io_apdu_buffer[i]) {
-        strings.common.gatewayFee[tickerOffset + i] = G_io_apdu_buffer[i];
-        i++;
+
+  // Transactions of an approved batch are signed without review
+  if (batchActive()) {
+    if (!batchAuthorize()) {
+      reset_app_context();
+      if (direct) {
+        THROW(0x6A80);
+      }
+      else {
+        io_seproxyhal_send_status(0x6A80);
+        ui_idle();
+        return;
+      }
     }
-  strings.common.gatewayFee[tickerOffset + i] = '\0';
-  // Compute maximum fee
-  convertUint256BE(tmpContent.txContent.gasprice.value, tmpContent.txContent.gasprice.length, &gasPrice);
-  convertUint256BE(tmpContent.txContent.startgas.value, tmpContent.txContent.startgas.length, &startGas);
-  mul256(&gasPrice, &startGas, &uint256);
-  tostring256(&uint256, 10, (char *)(G_io_apdu_buffer + 100), 100);
-  i = 0;
-  while (G_io_apdu_buffer[100 + i]) {
-    i++;
+    io_seproxyhal_touch_tx_ok(NULL);
+    return;
   }
-  adjustDecimals((char *)(G_io_apdu_buffer + 100), i, (char *)G_io_apdu_buffer, 100, feeDecimals);
-  i = 0;
-  tickerOffset=0;
-  while (feeTicker[tickerOffset]) {
-      strings.common.maxFee[tickerOffset] = feeTicker[tickerOffset];
-      tickerOffset++;
-  }
-  while (G_io_apdu_buffer[i]) {
-    strings.common.maxFee[tickerOffset + i] = G_io_apdu_buffer[i];
-    i++;
+
+  // Transactions within the signing policy are signed without review, the
+  // others are reviewed as usual
+  if (policyAuthorize()) {
+    io_seproxyhal_touch_tx_ok(NULL);
+    return;
   }
-  strings.common.maxFee[tickerOffset + i] = '\0';
 
 #ifdef NO_CONSENT
   io_seproxyhal_touch_tx_ok(NULL);
@@ -3,23 +3,53 @@
 #include <stdint.h>
 #include "ethUstream.h"
 #include "tokens.h"
+#include "globals.h"
 
 void io_seproxyhal_send_status(uint32_t sw);
 void format_signature_out(const uint8_t* signature);
+// Recovery ID of a signature from the cx_ecdsa_sign info flags
+uint8_t get_recovery_id(unsigned int info);
+// Sends v and the r and s formatted in G_io_apdu_buffer, followed by the
+// P2_RECOVERY_ID and P2_FULL_V options in flags, and resets the context
+void send_signature_out(uint8_t recoveryId, uint32_t v, uint8_t flags);
 uint32_t set_result_get_publicKey();
 void reset_app_context();
 
 tokenDefinition_t* getKnownToken(uint8_t *tokenAddr);
 
+// Currencies are identified by their token address, zero for the native one
+extern const uint8_t NATIVE_CURRENCY[20];
+
+// Ticker and decimals of a currency, which must be native or a provided token
+bool lookupCurrency(const uint8_t *token, char *ticker, uint8_t *decimals);
+
+// Reads a path as its number of derivations followed by the big endian
+// indexes, returns 0 on success
+int parse_bip32_path(bip32Path_t *derivationPath, const uint8_t *input, size_t len);
+
 customStatus_e customProcessor(txContext_t *context);
 void initTx(txContext_t *context, cx_sha3_t *sha3, txContent_t *content, ustreamProcess_t customProcessor, bool isEthereum, void *extra);
 void finalizeParsing(bool direct);
 
+typedef enum {
+  REVIEW_AMOUNT,
+  REVIEW_ADDRESS,
+  REVIEW_MAX_FEE,
+  REVIEW_GATEWAY_FEE,
+  REVIEW_GATEWAY_ADDRESS
+} reviewField_e;
+
+// Renders a review screen of the parsed transaction into strings.common
+void formatReviewField(reviewField_e field);
+
 // TODO: this should not be exposed
 typedef enum {
   APP_STATE_IDLE,
   APP_STATE_SIGNING_TX,
-  APP_STATE_SIGNING_MESSAGE
+  APP_STATE_SIGNING_MESSAGE,
+  APP_STATE_SIGNING_TYPED_DATA,
+  // Receiving a signing policy, then waiting for its approval
+  APP_STATE_SETTING_POLICY
 } app_state_t;
 
 extern volatile uint8_t appState;
\ No newline at end of file
@@ -0,0 +1,576 @@
+#include "eip712.h"
+
+#include "os.h"
+#include "cx.h"
+#include "ux.h"
+
+#include "address_cache.h"
+#include "globals.h"
+#include "hexUtils.h"
+#include "uint256.h"
+
+#include <string.h>
+
+typedef enum {
+  PENDING_NONE,
+  // encodeType string of the struct being opened, hashed in sha3
+  PENDING_TYPE,
+  // Dynamic value, hashed in sha3
+  PENDING_VALUE
+} pending_e;
+
+typedef enum {
+  LEVEL_NONE,
+  // Struct or array being hashed in sha3
+  LEVEL_STRUCT,
+  LEVEL_ARRAY
+} level_e;
+
+// Bytes of the hash shown on each side of the fingerprint
+#define FINGERPRINT_LENGTH 2
+
+static const uint8_t TYPED_DATA_PREFIX[] = { 0x19, 0x01 };
+
+void typedDataInit(void) {
+  explicit_bzero(&tmpCtx.typedDataContext, sizeof(tmpCtx.typedDataContext));
+}
+
+// Adds a member encoding to the open struct or array
+static void absorb(const uint8_t *word) {
+  cx_hash((cx_hash_t *)&sha3, 0, word, 32, NULL, 0);
+}
+
+static void pushDigest(const uint8_t *digest) {
+  if (tmpCtx.typedDataContext.digestCount == EIP712_MAX_DIGESTS) {
+    PRINTF("Too many pending digests\n");
+    THROW(0x6A80);
+  }
+  memcpy(tmpContent.typedDataDigests[tmpCtx.typedDataContext.digestCount++], digest, 32);
+}
+
+static void openLevel(level_e level, const uint8_t *typeHash) {
+  cx_keccak_init(&sha3, 256);
+  tmpCtx.typedDataContext.level = level;
+  if (typeHash != NULL) {
+    absorb(typeHash);
+  }
+}
+
+// Hashes the root structs, returns true once the message is hashed
+static bool closeRoot(const uint8_t *hash) {
+  // Every nested digest belongs to a root struct
+  if (tmpCtx.typedDataContext.digestCount != 0) {
+    THROW(0x6A80);
+  }
+  if (tmpCtx.typedDataContext.structCount++ == 0) {
+    memcpy(tmpCtx.typedDataContext.domainHash, hash, 32);
+    return false;
+  }
+  // Nothing but hashes would be reviewed
+  if ((tmpCtx.typedDataContext.fieldCount == 0) && !N_storage.dataAllowed) {
+    PRINTF("No typed data field shown\n");
+    THROW(0x6A80);
+  }
+  cx_keccak_init(&sha3, 256);
+  cx_hash((cx_hash_t *)&sha3, 0, TYPED_DATA_PREFIX, sizeof(TYPED_DATA_PREFIX), NULL, 0);
+  cx_hash((cx_hash_t *)&sha3, 0, tmpCtx.typedDataContext.domainHash, 32, NULL, 0);
+  cx_hash((cx_hash_t *)&sha3, CX_LAST, hash, 32, tmpCtx.typedDataContext.hash, 32);
+  return true;
+}
+
+// Position in the type string of the open struct, whose primary type is
+// parsed up to its closing parenthesis
+typedef enum {
+  TYPE_STRUCT_NAME,
+  TYPE_MEMBER_TYPE,
+  TYPE_MEMBER_NAME,
+  TYPE_DONE
+} typeState_e;
+
+// Index of a member in the declared ones, -1 if it is not declared
+static int8_t findDeclared(uint8_t member) {
+  for (uint8_t i = 0; i < tmpCtx.typedDataContext.declaredCount; i++) {
+    if (tmpCtx.typedDataContext.declaredMembers[i] == member) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static bool isDigits(const char *text, uint8_t length) {
+  if (length == 0) {
+    return false;
+  }
+  for (uint8_t i = 0; i < length; i++) {
+    if ((text[i] < '0') || (text[i] > '9')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool startsWith(const char *text, uint8_t length, const char *prefix) {
+  uint8_t prefixLength = strlen(prefix);
+  return (length >= prefixLength) && (memcmp(text, prefix, prefixLength) == 0);
+}
+
+// Format of a member type. Struct and array types, as well as the types too
+// long for the token, are nested digests.
+static uint8_t memberFormat(const char *type, uint8_t length) {
+  if (length > sizeof(tmpCtx.typedDataContext.token)) {
+    return TYPED_DATA_DIGEST;
+  }
+  if ((length == 7) && (memcmp(type, "address", 7) == 0)) {
+    return TYPED_DATA_ADDRESS;
+  }
+  if ((length == 6) && (memcmp(type, "string", 6) == 0)) {
+    return TYPED_DATA_STRING;
+  }
+  if ((length == 5) && (memcmp(type, "bytes", 5) == 0)) {
+    return TYPED_DATA_BYTES;
+  }
+  if (startsWith(type, length, "uint") && isDigits(type + 4, length - 4)) {
+    return TYPED_DATA_UINT;
+  }
+  if (((length == 4) && (memcmp(type, "bool", 4) == 0)) ||
+      (startsWith(type, length, "int") && isDigits(type + 3, length - 3)) ||
+      (startsWith(type, length, "bytes") && isDigits(type + 5, length - 5))) {
+    return TYPED_DATA_WORD;
+  }
+  return TYPED_DATA_DIGEST;
+}
+
+// Reads the members of the primary type from a chunk of the type string,
+// keeping the format and name of the declared ones
+static void parseType(const uint8_t *workBuffer, uint16_t dataLength) {
+  typedDataContext_t *context = &tmpCtx.typedDataContext;
+  int8_t declared;
+  for (uint16_t i = 0; (i < dataLength) && (context->typeState != TYPE_DONE); i++) {
+    char c = workBuffer[i];
+    switch (context->typeState) {
+      case TYPE_STRUCT_NAME:
+        if (c == '(') {
+          context->typeState = TYPE_MEMBER_TYPE;
+        }
+        break;
+      case TYPE_MEMBER_TYPE:
+        if ((c == ')') && (context->tokenLength == 0) && (context->memberCount == 0)) {
+          context->typeState = TYPE_DONE;
+        }
+        else if (c == ' ') {
+          if (context->tokenLength == 0) {
+            THROW(0x6A80);
+          }
+          declared = findDeclared(context->memberCount);
+          if (declared >= 0) {
+            context->declaredFormats[declared] = memberFormat(context->token, context->tokenLength);
+          }
+          context->tokenLength = 0;
+          context->typeState = TYPE_MEMBER_NAME;
+        }
+        else if ((c == ',') || (c == '(') || (c == ')')) {
+          THROW(0x6A80);
+        }
+        else {
+          if (context->tokenLength < sizeof(context->token)) {
+            context->token[context->tokenLength] = c;
+          }
+          // Saturated, any length above the token is a nested type
+          context->tokenLength = MIN(context->tokenLength + 1, (int) sizeof(context->token) + 1);
+        }
+        break;
+      case TYPE_MEMBER_NAME:
+        if ((c == ',') || (c == ')')) {
+          if ((context->tokenLength == 0) || (context->memberCount == UINT8_MAX)) {
+            THROW(0x6A80);
+          }
+          context->memberCount++;
+          context->tokenLength = 0;
+          context->typeState = (c == ',' ? TYPE_MEMBER_TYPE : TYPE_DONE);
+        }
+        else if ((c == ' ') || (c == '(')) {
+          THROW(0x6A80);
+        }
+        else {
+          declared = findDeclared(context->memberCount);
+          // Long names are truncated
+          if ((declared >= 0) && (context->tokenLength < EIP712_NAME_LENGTH)) {
+            context->declaredNames[declared][context->tokenLength] = c;
+          }
+          context->tokenLength = MIN(context->tokenLength + 1, EIP712_NAME_LENGTH);
+        }
+        break;
+    }
+  }
+}
+
+// Reads the members declared in the first command of a struct, returns the
+// offset of its type string
+static uint16_t parseDeclared(const uint8_t *workBuffer, uint16_t dataLength) {
+  typedDataContext_t *context = &tmpCtx.typedDataContext;
+  uint8_t count;
+  if (dataLength < 1) {
+    THROW(0x6700);
+  }
+  count = workBuffer[0];
+  if (count > EIP712_MAX_FIELDS) {
+    THROW(0x6A80);
+  }
+  if (dataLength < 1 + count) {
+    THROW(0x6700);
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    // In increasing order, so that each member is declared once
+    if ((i != 0) && (workBuffer[1 + i] <= workBuffer[i])) {
+      THROW(0x6A80);
+    }
+    context->declaredMembers[i] = workBuffer[1 + i];
+  }
+  context->declaredCount = count;
+  memset(context->declaredNames, 0, sizeof(context->declaredNames));
+  context->memberCount = 0;
+  context->memberIndex = 0;
+  context->typeState = TYPE_STRUCT_NAME;
+  context->tokenLength = 0;
+  return 1 + count;
+}
+
+static void processStruct(uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength) {
+  uint8_t typeHash[32];
+  uint16_t offset = 0;
+  if (tmpCtx.typedDataContext.pending == PENDING_NONE) {
+    if ((tmpCtx.typedDataContext.level != LEVEL_NONE) || (tmpCtx.typedDataContext.structCount == 2)) {
+      THROW(0x6985);
+    }
+    offset = parseDeclared(workBuffer, dataLength);
+    cx_keccak_init(&sha3, 256);
+    tmpCtx.typedDataContext.pending = PENDING_TYPE;
+  }
+  else if (tmpCtx.typedDataContext.pending != PENDING_TYPE) {
+    THROW(0x6985);
+  }
+  parseType(workBuffer + offset, dataLength - offset);
+  cx_hash((cx_hash_t *)&sha3, 0, workBuffer + offset, dataLength - offset, NULL, 0);
+  if (p2 & P2_TYPED_DATA_MORE) {
+    return;
+  }
+  // Declared members must exist, in increasing order the last one is enough
+  if ((tmpCtx.typedDataContext.typeState != TYPE_DONE) ||
+      ((tmpCtx.typedDataContext.declaredCount != 0) &&
+       (tmpCtx.typedDataContext.declaredMembers[tmpCtx.typedDataContext.declaredCount - 1] >=
+        tmpCtx.typedDataContext.memberCount))) {
+    THROW(0x6A80);
+  }
+  tmpCtx.typedDataContext.pending = PENDING_NONE;
+  cx_hash((cx_hash_t *)&sha3, CX_LAST, workBuffer, 0, typeHash, 32);
+  openLevel(LEVEL_STRUCT, typeHash);
+}
+
+// Labels the shown fields carried by the digest at the top of the stack with
+// the member of the open struct that receives it, or refuses them in arrays
+static void bindDigest(int8_t declared) {
+  typedDataContext_t *context = &tmpCtx.typedDataContext;
+  bool carried = false;
+  for (uint8_t i = 0; i < context->fieldCount; i++) {
+    typedDataField_t *field = &context->fields[i];
+    char label[EIP712_NAME_LENGTH + 1];
+    if (field->owner != context->digestCount) {
+      continue;
+    }
+    if (declared < 0) {
+      PRINTF("Shown field in an undeclared member\n");
+      THROW(0x6A80);
+    }
+    carried = true;
+    if (field->name[0] == '\0') {
+      // The dynamic value itself
+      if (context->declaredFormats[declared] != field->format) {
+        THROW(0x6A80);
+      }
+      strcpy(field->name, context->declaredNames[declared]);
+    }
+    else {
+      if (context->declaredFormats[declared] != TYPED_DATA_DIGEST) {
+        THROW(0x6A80);
+      }
+      snprintf(label, sizeof(label), "%s.%s", context->declaredNames[declared], field->name);
+      strcpy(field->name, label);
+    }
+    field->owner = TYPED_DATA_OWNER_OPEN;
+  }
+  if ((declared >= 0) && !carried) {
+    THROW(0x6A80);
+  }
+}
+
+// Adds the next member of the open struct or array from the top of the stack
+static void popDigest(void) {
+  typedDataContext_t *context = &tmpCtx.typedDataContext;
+  if (context->digestCount == 0) {
+    THROW(0x6A80);
+  }
+  if (context->level == LEVEL_STRUCT) {
+    bindDigest(findDeclared(context->memberIndex++));
+  }
+  else {
+    // Array elements have no name to show
+    bindDigest(-1);
+  }
+  absorb(tmpContent.typedDataDigests[--context->digestCount]);
+}
+
+static void processValue(uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength) {
+  // Shown field the value is kept in
+  static typedDataField_t *field;
+  typedDataContext_t *context = &tmpCtx.typedDataContext;
+  uint8_t hash[32];
+  uint8_t format;
+  uint16_t offset = 0;
+  int8_t declared = -1;
+
+  if (context->pending == PENDING_NONE) {
+    if (dataLength < 1) {
+      THROW(0x6700);
+    }
+    format = workBuffer[0];
+    offset = 1;
+    if ((format > TYPED_DATA_DIGEST) ||
+        ((format == TYPED_DATA_DIGEST) && (p2 & P2_TYPED_DATA_DISPLAY)) ||
+        ((context->level == LEVEL_ARRAY) && (p2 & P2_TYPED_DATA_DISPLAY))) {
+      THROW(0x6A80);
+    }
+    // Dynamic values are hashed in sha3, before the struct or array they
+    // belong to is opened
+    if ((context->level == LEVEL_NONE) != ((format == TYPED_DATA_STRING) || (format == TYPED_DATA_BYTES))) {
+      THROW(0x6985);
+    }
+    if ((context->level == LEVEL_STRUCT) && (context->memberIndex == context->memberCount)) {
+      THROW(0x6A80);
+    }
+    if (format == TYPED_DATA_DIGEST) {
+      if ((dataLength != offset) || (p2 & P2_TYPED_DATA_MORE)) {
+        THROW(0x6A80);
+      }
+      popDigest();
+      return;
+    }
+    if (context->level == LEVEL_STRUCT) {
+      // Shown words are the declared members, of the declared type
+      declared = findDeclared(context->memberIndex);
+      if (((declared >= 0) != ((p2 & P2_TYPED_DATA_DISPLAY) != 0)) ||
+          ((declared >= 0) && (context->declaredFormats[declared] != format))) {
+        THROW(0x6A80);
+      }
+    }
+    field = NULL;
+    if (p2 & P2_TYPED_DATA_DISPLAY) {
+      if (context->fieldCount == EIP712_MAX_FIELDS) {
+        PRINTF("Too many fields shown\n");
+        THROW(0x6A80);
+      }
+      field = &context->fields[context->fieldCount];
+      memset(field, 0, sizeof(typedDataField_t));
+      field->format = format;
+      if (declared >= 0) {
+        strcpy(field->name, context->declaredNames[declared]);
+      }
+    }
+    if (format < TYPED_DATA_STRING) {
+      if ((dataLength != offset + 32) || (p2 & P2_TYPED_DATA_MORE)) {
+        THROW(0x6A80);
+      }
+      absorb(workBuffer + offset);
+      context->memberIndex++;
+      if (field != NULL) {
+        memcpy(field->value, workBuffer + offset, 32);
+        context->fieldCount++;
+      }
+      return;
+    }
+    cx_keccak_init(&sha3, 256);
+    context->pending = PENDING_VALUE;
+    // Any error until the value is complete resets the context
+    if (field != NULL) {
+      context->fieldCount++;
+    }
+  }
+  else if (context->pending != PENDING_VALUE) {
+    THROW(0x6985);
+  }
+  if (field != NULL) {
+    uint16_t kept = MIN(dataLength - offset, 32 - MIN(field->length, 32));
+    memcpy(field->value + MIN(field->length, 32), workBuffer + offset, kept);
+    // Saturated, any length above the kept bytes is shown as truncated
+    field->length = MIN((uint32_t)field->length + (dataLength - offset), UINT16_MAX);
+  }
+  cx_hash((cx_hash_t *)&sha3, 0, workBuffer + offset, dataLength - offset, NULL, 0);
+  if (p2 & P2_TYPED_DATA_MORE) {
+    return;
+  }
+  context->pending = PENDING_NONE;
+  cx_hash((cx_hash_t *)&sha3, CX_LAST, workBuffer, 0, hash, 32);
+  pushDigest(hash);
+  if (field != NULL) {
+    // Named by the member of the struct that takes the digest
+    field->owner = context->digestCount;
+  }
+}
+
+// Hands the shown fields of the closed struct or array to the digest it
+// left, or to the domain or message
+static void closeFields(uint8_t owner) {
+  for (uint8_t i = 0; i < tmpCtx.typedDataContext.fieldCount; i++) {
+    if (tmpCtx.typedDataContext.fields[i].owner == TYPED_DATA_OWNER_OPEN) {
+      tmpCtx.typedDataContext.fields[i].owner = owner;
+    }
+  }
+}
+
+bool typedDataProcess(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength) {
+  uint8_t hash[32];
+  uint8_t allowed;
+
+  switch (p1) {
+    case P1_TYPED_DATA_STRUCT:
+      allowed = P2_TYPED_DATA_MORE;
+      break;
+    case P1_TYPED_DATA_VALUE:
+      allowed = P2_TYPED_DATA_MORE | P2_TYPED_DATA_DISPLAY;
+      break;
+    case P1_TYPED_DATA_ARRAY:
+      allowed = 0;
+      break;
+    case P1_TYPED_DATA_END:
+      allowed = P2_TYPED_DATA_ROOT;
+      break;
+    default:
+      THROW(0x6B00);
+  }
+  if (p2 & ~allowed) {
+    THROW(0x6B00);
+  }
+  if (p1 == P1_TYPED_DATA_STRUCT) {
+    processStruct(p2, workBuffer, dataLength);
+    return false;
+  }
+  if (p1 == P1_TYPED_DATA_VALUE) {
+    processValue(p2, workBuffer, dataLength);
+    return false;
+  }
+  if (dataLength != 0) {
+    THROW(0x6A80);
+  }
+  if (tmpCtx.typedDataContext.pending != PENDING_NONE) {
+    THROW(0x6985);
+  }
+  if (p1 == P1_TYPED_DATA_ARRAY) {
+    if (tmpCtx.typedDataContext.level != LEVEL_NONE) {
+      THROW(0x6985);
+    }
+    openLevel(LEVEL_ARRAY, NULL);
+    return false;
+  }
+  if ((tmpCtx.typedDataContext.level == LEVEL_NONE) ||
+      ((p2 & P2_TYPED_DATA_ROOT) && (tmpCtx.typedDataContext.level != LEVEL_STRUCT))) {
+    THROW(0x6985);
+  }
+  // Every member of a struct is received
+  if ((tmpCtx.typedDataContext.level == LEVEL_STRUCT) &&
+      (tmpCtx.typedDataContext.memberIndex != tmpCtx.typedDataContext.memberCount)) {
+    THROW(0x6A80);
+  }
+  tmpCtx.typedDataContext.level = LEVEL_NONE;
+  cx_hash((cx_hash_t *)&sha3, CX_LAST, hash, 0, hash, 32);
+  if (p2 & P2_TYPED_DATA_ROOT) {
+    closeFields(TYPED_DATA_OWNER_ROOT);
+    return closeRoot(hash);
+  }
+  pushDigest(hash);
+  closeFields(tmpCtx.typedDataContext.digestCount);
+  return false;
+}
+
+// Printable part of a string value, dots replacing the other bytes
+static void formatString(const typedDataField_t *field, char *out, size_t outLength) {
+  uint16_t length = MIN(field->length, sizeof(field->value));
+  uint16_t i;
+  for (i = 0; (i < length) && (i < outLength - 4); i++) {
+    out[i] = (((field->value[i] >= 0x20) && (field->value[i] < 0x7f)) ? field->value[i] : '.');
+  }
+  if (i < field->length) {
+    strcpy(out + i, "...");
+  }
+  else {
+    out[i] = '\0';
+  }
+}
+
+static void formatHex(const uint8_t *data, uint16_t length, uint16_t available, char *out, size_t outLength) {
+  // Room for the prefix, the ellipsis and the terminating zero
+  uint16_t shown = MIN(available, (outLength - 2 - 3 - 1) / 2);
+  out[0] = '0';
+  out[1] = 'x';
+  hexEncodeLowercase(data, shown, out + 2);
+  strcpy(out + 2 + 2 * shown, (shown < length ? "..." : ""));
+}
+
+void formatTypedDataField(void) {
+  char *out = strings.common.display;
+  size_t outLength = sizeof(strings.common.display);
+  const typedDataField_t *field;
+  uint256_t number;
+
+  if (tmpCtx.typedDataContext.fieldCount == 0) {
+    strcpy(strings.common.title, "Fields");
+    strcpy(out, "None shown");
+    return;
+  }
+  field = &tmpCtx.typedDataContext.fields[tmpCtx.typedDataContext.fieldIndex];
+  snprintf(strings.common.title, sizeof(strings.common.title), "%d/%d %s",
+           tmpCtx.typedDataContext.fieldIndex + 1, tmpCtx.typedDataContext.fieldCount, field->name);
+  switch (field->format) {
+    case TYPED_DATA_UINT:
+      readu256BE(field->value, &number);
+      if (tostring256(&number, 10, out, outLength)) {
+        break;
+      }
+      formatHex(field->value, 32, 32, out, outLength);
+      break;
+    case TYPED_DATA_ADDRESS:
+      out[0] = '0';
+      out[1] = 'x';
+      getCachedAddressString(field->value + 12, out + 2);
+      break;
+    case TYPED_DATA_WORD:
+      formatHex(field->value, 32, 32, out, outLength);
+      break;
+    case TYPED_DATA_STRING:
+      formatString(field, out, outLength);
+      break;
+    case TYPED_DATA_BYTES:
+      formatHex(field->value, field->length, MIN(field->length, sizeof(field->value)), out, outLength);
+      break;
+  }
+}
+
+void typedDataNextField(void) {
+  if (tmpCtx.typedDataContext.fieldCount != 0) {
+    tmpCtx.typedDataContext.fieldIndex = (tmpCtx.typedDataContext.fieldIndex + 1) % tmpCtx.typedDataContext.fieldCount;
+  }
+  ux_flow_relayout();
+}
+
+static void formatFingerprint(const uint8_t *hash) {
+  char *out = strings.common.display;
+  hexEncode(hash, FINGERPRINT_LENGTH, out);
+  strcpy(out + 2 * FINGERPRINT_LENGTH, "...");
+  hexEncode(hash + 32 - FINGERPRINT_LENGTH, FINGERPRINT_LENGTH, out + 2 * FINGERPRINT_LENGTH + 3);
+}
+
+void formatTypedDataDomain(void) {
+  formatFingerprint(tmpCtx.typedDataContext.domainHash);
+}
+
+void formatTypedDataHash(void) {
+  formatFingerprint(tmpCtx.typedDataContext.hash);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// EIP 712 typed data signing. The host walks the domain then the message
+// children first: the nested structs, arrays and dynamic values of a struct
+// or array are hashed before it is opened, last member first, and leave their
+// digest on a stack. The struct is then opened with its encodeType string,
+// receives its member values in order, taking the nested ones from the top of
+// the stack, and is closed, leaving its own digest. A single struct or array
+// is hashed at a time, in sha3, so the payload is never buffered and deep
+// data costs 32 bytes per pending digest rather than a Keccak context per
+// level.
+//
+// Shown values are bound to the type strings: a struct is opened with the
+// indexes of its members that are shown or hold shown fields, and their names
+// and types are read from the type string as it is hashed. The host only
+// flags the values to show, their labels and formats come from the types.
+
+#define P1_TYPED_DATA_START 0x00
+#define P1_TYPED_DATA_STRUCT 0x01
+#define P1_TYPED_DATA_ARRAY 0x02
+#define P1_TYPED_DATA_VALUE 0x03
+#define P1_TYPED_DATA_END 0x04
+
+// More data of the same type string or dynamic value follows
+#define P2_TYPED_DATA_MORE 0x80
+// The value is shown in the review
+#define P2_TYPED_DATA_DISPLAY 0x01
+// The closed struct is the domain or the message
+#define P2_TYPED_DATA_ROOT 0x01
+
+// Owner of a shown field not carried by a pending digest: the open struct,
+// or the domain or message once closed
+#define TYPED_DATA_OWNER_OPEN 0x00
+#define TYPED_DATA_OWNER_ROOT 0xFF
+
+typedef enum {
+  // 32 bytes words, as encoded by encodeData
+  TYPED_DATA_UINT,
+  TYPED_DATA_ADDRESS,
+  // Other words (int, bool, bytes1 to bytes32), shown in hex
+  TYPED_DATA_WORD,
+  // Dynamic values, hashed
+  TYPED_DATA_STRING,
+  TYPED_DATA_BYTES,
+  // Nested struct, array or dynamic value, taken from the digest stack
+  TYPED_DATA_DIGEST
+} typedDataFormat_e;
+
+// Resets tmpCtx.typedDataContext, before the path is set
+void typedDataInit(void);
+
+// Processes a STRUCT, ARRAY, VALUE or END command. Returns true once the
+// message struct is closed and tmpCtx.typedDataContext.hash holds the hash
+// to sign.
+bool typedDataProcess(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength);
+
+// Renders the current field of the review into strings.common
+void formatTypedDataField(void);
+// Shows the next field of the review
+void typedDataNextField(void);
+// Renders the fingerprint of the domain separator into strings.common.display
+void formatTypedDataDomain(void);
+// Renders the fingerprint of the hash to sign into strings.common.display
+void formatTypedDataHash(void);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ethUstream.h"
+#include "policy.h"
 #include "tokens.h"
 #include "cx.h"
 
@@ -8,9 +9,27 @@
 #define CHAINID_COINNAME "CELO"
 #define CHAIN_ID 0
 
+// EIP 712 nested structs, arrays and dynamic values hashed and waiting to be
+// taken by their parent, 32 bytes each
+#ifndef EIP712_MAX_DIGESTS
+#ifdef TARGET_NANOS
+#define EIP712_MAX_DIGESTS 6
+#else
+#define EIP712_MAX_DIGESTS 16
+#endif
+#endif
+
+// Typed data fields shown in the review
+#ifndef EIP712_MAX_FIELDS
+#define EIP712_MAX_FIELDS 4
+#endif
+
+#define EIP712_NAME_LENGTH 16
+
 typedef union {
   txContent_t txContent;
-  cx_sha256_t sha2;
+  // Pending EIP 712 digests, the most recent last
+  uint8_t typedDataDigests[EIP712_MAX_DIGESTS][32];
 } tmpContent_t;
 
 extern tmpContent_t tmpContent;
@@ -18,8 +37,6 @@ extern tmpContent_t tmpContent;
 extern txContext_t txContext;
 
 
-#define MAX_TOKEN 2
-
 #define MAX_BIP32_PATH 10
 
 typedef struct bip32Path_t {
@@ -27,41 +44,107 @@ typedef struct bip32Path_t {
     uint32_t path[MAX_BIP32_PATH];
 } bip32Path_t;
 
+// GET_PUBLIC_KEY response options, combined in P2
+#define P2_NO_CHAINCODE 0x00
+#define P2_CHAINCODE 0x01
+#define P2_COMPRESSED_KEY 0x02
+// Binary address, without the checksum computation
+#define P2_RAW_ADDRESS 0x04
+// No address at all
+#define P2_KEY_ONLY 0x08
+
+// Signature response options, combined in P2 of the signing commands
+// Recovery ID (parity and x >= n), as one byte after the signature
+#define P2_RECOVERY_ID 0x01
+// Full width v, as 4 big endian bytes after the signature and recovery ID
+#define P2_FULL_V 0x02
+
 typedef struct publicKeyContext_t {
     cx_ecfp_public_key_t publicKey;
     char address[41];
+    uint8_t rawAddress[20];
     uint8_t chainCode[32];
-    bool getChaincode;
+    uint8_t responseFlags;
 } publicKeyContext_t;
 
 typedef struct messageSigningContext_t {
     bip32Path_t derivationPath;
     uint8_t hash[32];
     uint32_t remainingLength;
+    uint8_t responseFlags;
 } messageSigningContext_t;
 
+typedef struct typedDataField_t {
+    // Member name from the type string, prefixed by the names of the members
+    // of the parent structs
+    char name[EIP712_NAME_LENGTH + 1];
+    uint8_t format;
+    // Position of the pending digest the field belongs to, or one of the
+    // TYPED_DATA_OWNER values
+    uint8_t owner;
+    // Length of a dynamic value, of which only the first bytes are kept
+    uint16_t length;
+    uint8_t value[32];
+} typedDataField_t;
+
+typedef struct typedDataContext_t {
+    bip32Path_t derivationPath;
+    uint8_t hash[32];
+    uint8_t responseFlags;
+    uint8_t domainHash[32];
+    // Struct or array being hashed in sha3
+    uint8_t level;
+    uint8_t digestCount;
+    // Number of top level structs hashed, the domain then the message
+    uint8_t structCount;
+    // Type string or dynamic value being hashed over several commands
+    uint8_t pending;
+    uint8_t fieldCount;
+    // Field shown in the review
+    uint8_t fieldIndex;
+    typedDataField_t fields[EIP712_MAX_FIELDS];
+    // Members of the open struct, counted in its type string, then as their
+    // values are received
+    uint8_t memberCount;
+    uint8_t memberIndex;
+    // Members of the open struct that are shown or hold shown fields, with
+    // their format and name parsed from the type string
+    uint8_t declaredCount;
+    uint8_t declaredMembers[EIP712_MAX_FIELDS];
+    uint8_t declaredFormats[EIP712_MAX_FIELDS];
+    char declaredNames[EIP712_MAX_FIELDS][EIP712_NAME_LENGTH + 1];
+    // Type string parser state, and the member type or name being read
+    uint8_t typeState;
+    uint8_t tokenLength;
+    char token[8];
+} typedDataContext_t;
+
 typedef struct transactionContext_t {
     bip32Path_t derivationPath;
     uint8_t hash[32];
-    tokenDefinition_t tokens[MAX_TOKEN];
-    uint8_t tokenSet[MAX_TOKEN];
-    uint8_t currentTokenIndex;
+    // Token of a transfer being reviewed, NULL for a native amount
+    tokenDefinition_t *amountToken;
+    // Function selector of the data field, when present
+    uint8_t selector[4];
+    uint8_t responseFlags;
 } transactionContext_t;
 
 typedef union {
     publicKeyContext_t publicKeyContext;
     transactionContext_t transactionContext;
     messageSigningContext_t messageSigningContext;
+    typedDataContext_t typedDataContext;
+    // Signing policy declared, until the user approves it
+    policy_t policyContext;
 } tmpCtx_t;
 
 extern tmpCtx_t tmpCtx;
 
 typedef struct strData_t {
-    char fullAddress[43];
-    char fullGatewayAddress[43];
-    char fullAmount[50];
-    char maxFee[50];
-    char gatewayFee[50];
+    // Text of the current screen. Review steps render it from the parsed
+    // transaction when they are displayed.
+    char display[50];
+    char title[24];
 } strData_t;
 
 typedef struct strDataTmp_t {
@@ -76,6 +159,15 @@ typedef union {
 
 extern strings_t strings;
 
+// Addresses whose checksummed string is already in the address cache
+#define PREFETCHED_ADDRESS 0x01
+#define PREFETCHED_GATEWAY_ADDRESS 0x02
+
+extern volatile uint8_t prefetchedAddresses;
+
+// Set when the operator expands compact amounts during a review
+extern volatile bool reviewExactAmounts;
+
 extern volatile bool dataPresent;
 extern volatile uint8_t dataAllowed;
 extern volatile uint8_t contractDetails;
@@ -83,6 +175,8 @@ extern volatile uint8_t contractDetails;
 typedef struct internalStorage_t {
   unsigned char dataAllowed;
   unsigned char contractDetails;
+  unsigned char compactAmounts;
+  unsigned char sessionCache;
   uint8_t initialized;
 } internalStorage_t;
 
@@ -0,0 +1,77 @@
+#include "key_cache.h"
+
+#include "os.h"
+
+#include <string.h>
+
+typedef struct keyCacheEntry_t {
+  bip32Path_t path;
+  cx_ecfp_public_key_t publicKey;
+  uint8_t address[20];
+  uint8_t chainCode[32];
+} keyCacheEntry_t;
+
+// Most recently used first, only the first count entries are valid
+static keyCacheEntry_t keyCache[KEY_CACHE_SIZE];
+static uint8_t keyCacheCount;
+
+static uint8_t walletId[WALLET_ID_LENGTH];
+static bool walletIdSet;
+
+static bool samePath(const bip32Path_t *a, const bip32Path_t *b) {
+  return (a->len == b->len) && (memcmp(a->path, b->path, a->len * sizeof(uint32_t)) == 0);
+}
+
+static void moveToFront(uint8_t index, const keyCacheEntry_t *entry) {
+  memmove(keyCache + 1, keyCache, index * sizeof(keyCacheEntry_t));
+  keyCache[0] = *entry;
+}
+
+bool lookupPublicKey(const bip32Path_t *path, cx_ecfp_public_key_t *publicKey,
+                     uint8_t *address, uint8_t *chainCode) {
+  keyCacheEntry_t entry;
+  for (uint8_t i = 0; i < keyCacheCount; i++) {
+    if (samePath(&keyCache[i].path, path)) {
+      entry = keyCache[i];
+      moveToFront(i, &entry);
+      memcpy(publicKey, &entry.publicKey, sizeof(cx_ecfp_public_key_t));
+      memcpy(address, entry.address, 20);
+      memcpy(chainCode, entry.chainCode, 32);
+      return true;
+    }
+  }
+  return false;
+}
+
+void storePublicKey(const bip32Path_t *path, const cx_ecfp_public_key_t *publicKey,
+                    const uint8_t *address, const uint8_t *chainCode) {
+  keyCacheEntry_t entry;
+  memcpy(&entry.path, path, sizeof(bip32Path_t));
+  memcpy(&entry.publicKey, publicKey, sizeof(cx_ecfp_public_key_t));
+  memcpy(entry.address, address, 20);
+  memcpy(entry.chainCode, chainCode, 32);
+  // Evicts the least recently used entry when full
+  if (keyCacheCount < KEY_CACHE_SIZE) {
+    keyCacheCount++;
+  }
+  moveToFront(keyCacheCount - 1, &entry);
+}
+
+bool lookupWalletId(uint8_t *out) {
+  if (walletIdSet) {
+    memcpy(out, walletId, WALLET_ID_LENGTH);
+  }
+  return walletIdSet;
+}
+
+void storeWalletId(const uint8_t *id) {
+  memcpy(walletId, id, WALLET_ID_LENGTH);
+  walletIdSet = true;
+}
+
+void keyCacheWipe(void) {
+  explicit_bzero(keyCache, sizeof(keyCache));
+  keyCacheCount = 0;
+  explicit_bzero(walletId, sizeof(walletId));
+  walletIdSet = false;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cx.h"
+#include "globals.h"
+
+// Number of derived public keys kept in RAM, only the last one on Nano S
+#ifndef KEY_CACHE_SIZE
+#ifdef TARGET_NANOS
+#define KEY_CACHE_SIZE 1
+#else
+#define KEY_CACHE_SIZE 3
+#endif
+#endif
+
+#define WALLET_ID_LENGTH 64
+
+// Public key, binary address and chain code of a path, if it was derived
+// recently. The entry is then moved to the front of the cache.
+bool lookupPublicKey(const bip32Path_t *path, cx_ecfp_public_key_t *publicKey,
+                     uint8_t *address, uint8_t *chainCode);
+void storePublicKey(const bip32Path_t *path, const cx_ecfp_public_key_t *publicKey,
+                    const uint8_t *address, const uint8_t *chainCode);
+
+bool lookupWalletId(uint8_t *out);
+void storeWalletId(const uint8_t *walletId);
+
+// Forgets every key and the wallet ID, on lock and exit
+void keyCacheWipe(void);
@@ -23,9 +23,20 @@
 #include "cx.h"
 #include "ethUstream.h"
 #include "ethUtils.h"
+#include "hexUtils.h"
 #include "uint256.h"
 #include "tokens.h"
 #include "celo.h"
+#include "address_cache.h"
+#include "session.h"
+#include "bip32.h"
+#include "key_cache.h"
+#include "batch.h"
+#include "policy.h"
+#include "eip712.h"
+#include "token_registry.h"
+#include "metadata.h"
+#include "tokenCache.h"
 
 #include "os_io_seproxyhal.h"
 
@@ -48,12 +59,20 @@ uint8_t G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
 #define INS_SIGN_PERSONAL_MESSAGE 0x08
 #define INS_PROVIDE_ERC20_TOKEN_INFORMATION 0x0A
 #define INS_GET_APP_TYPE 0x0C
+#define INS_GET_ADDRESSES 0x0E
+#define INS_DECLARE_BATCH 0x10
+#define INS_SET_POLICY 0x12
+#define INS_SIGN_TYPED_DATA 0x14
+#define INS_PROVIDE_METADATA 0x16
 #define P1_CONFIRM 0x01
 #define P1_NON_CONFIRM 0x00
-#define P2_NO_CHAINCODE 0x00
-#define P2_CHAINCODE 0x01
 #define P1_FIRST 0x00
 #define P1_MORE 0x80
+#define P1_METADATA_ROOT 0x00
+#define P1_METADATA_RECORD 0x01
+
+// Addresses returned by one INS_GET_ADDRESSES command
+#define MAX_BATCH_ADDRESSES 12
 
 #define COMMON_CLA 0xB0
 #define COMMON_INS_GET_WALLET_ID 0x04
@@ -94,6 +113,8 @@ volatile uint8_t dataAllowed;
 volatile uint8_t contractDetails;
 volatile bool dataPresent;
 volatile bool tokenProvisioned;
+volatile uint8_t prefetchedAddresses;
+volatile bool reviewExactAmounts;
 
 strings_t strings;
 
@@ -130,7 +151,7 @@ unsigned short io_exchange_al(unsigned char channel, unsigned short tx_len) {
 
 #define MAX_BIP32_PATH 10
 
-static int parse_bip32_path(bip32Path_t *derivationPath, const uint8_t *input, size_t len) {
+int parse_bip32_path(bip32Path_t *derivationPath, const uint8_t *input, size_t len) {
   uint8_t path_length;
 
   if (len == 0 || input == NULL) {
@@ -164,13 +185,17 @@ void handleGetWalletId(volatile unsigned int *tx) {
   unsigned char t[64];
   cx_ecfp_256_private_key_t priv;
   cx_ecfp_256_public_key_t pub;
-  // seed => priv key
-  os_perso_derive_node_bip32(CX_CURVE_256K1, U_os_perso_seed_cookie, 2, t, NULL);
-  // priv key => pubkey
-  cx_ecdsa_init_private_key(CX_CURVE_256K1, t, 32, &priv);
-  cx_ecfp_generate_pair(CX_CURVE_256K1, &pub, &priv, 1);
-  // pubkey -> sha512
-  cx_hash_sha512(pub.W, sizeof(pub.W), t, sizeof(t));
+  if (!lookupWalletId(t)) {
+    // seed => priv key
+    os_perso_derive_node_bip32(CX_CURVE_256K1, U_os_perso_seed_cookie, 2, t, NULL);
+    // priv key => pubkey
+    cx_ecdsa_init_private_key(CX_CURVE_256K1, t, 32, &priv);
+    cx_ecfp_generate_pair(CX_CURVE_256K1, &pub, &priv, 1);
+    explicit_bzero(&priv, sizeof(priv));
+    // pubkey -> sha512
+    cx_hash_sha512(pub.W, sizeof(pub.W), t, sizeof(t));
+    storeWalletId(t);
+  }
   // ! cookie !
   memcpy(G_io_apdu_buffer, t, 64);
   *tx = 64;
@@ -189,7 +214,8 @@ void handleGetPublicKey(uint8_t p1, uint8_t p2, uint8_t *dataBuffer, uint16_t da
   if ((p1 != P1_CONFIRM) && (p1 != P1_NON_CONFIRM)) {
     THROW(0x6B00);
   }
-  if ((p2 != P2_CHAINCODE) && (p2 != P2_NO_CHAINCODE)) {
+  if ((p2 & ~(P2_CHAINCODE | P2_COMPRESSED_KEY | P2_RAW_ADDRESS | P2_KEY_ONLY)) ||
+      ((p2 & P2_RAW_ADDRESS) && (p2 & P2_KEY_ONLY))) {
     THROW(0x6B00);
   }
 
@@ -198,16 +224,25 @@ void handleGetPublicKey(uint8_t p1, uint8_t p2, uint8_t *dataBuffer, uint16_t da
       THROW(0x6a80);
   }
 
-  tmpCtx.publicKeyContext.getChaincode = (p2 == P2_CHAINCODE);
-  io_seproxyhal_io_heartbeat();
-  os_perso_derive_node_bip32(CX_CURVE_256K1, derivationPath.path, derivationPath.len, privateKeyData, (tmpCtx.publicKeyContext.getChaincode ? tmpCtx.publicKeyContext.chainCode : NULL));
-  cx_ecfp_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &privateKey);
-  io_seproxyhal_io_heartbeat();
-  cx_ecfp_generate_pair(CX_CURVE_256K1, &tmpCtx.publicKeyContext.publicKey, &privateKey, 1);
-  explicit_bzero(&privateKey, sizeof(privateKey));
-  explicit_bzero(privateKeyData, sizeof(privateKeyData));
-  io_seproxyhal_io_heartbeat();
-  getEthAddressStringFromKey(&tmpCtx.publicKeyContext.publicKey, tmpCtx.publicKeyContext.address, CHAIN_ID, &sha3);
+  tmpCtx.publicKeyContext.responseFlags = p2;
+  // The chain code is always derived, so that the cached entry of the path
+  // serves every P2
+  if (!lookupPublicKey(&derivationPath, &tmpCtx.publicKeyContext.publicKey, tmpCtx.publicKeyContext.rawAddress, tmpCtx.publicKeyContext.chainCode)) {
+    io_seproxyhal_io_heartbeat();
+    deriveNode(&derivationPath, privateKeyData, tmpCtx.publicKeyContext.chainCode);
+    cx_ecfp_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &privateKey);
+    io_seproxyhal_io_heartbeat();
+    cx_ecfp_generate_pair(CX_CURVE_256K1, &tmpCtx.publicKeyContext.publicKey, &privateKey, 1);
+    explicit_bzero(&privateKey, sizeof(privateKey));
+    explicit_bzero(privateKeyData, sizeof(privateKeyData));
+    io_seproxyhal_io_heartbeat();
+    getEthAddressFromKey(&tmpCtx.publicKeyContext.publicKey, tmpCtx.publicKeyContext.rawAddress, &sha3);
+    storePublicKey(&derivationPath, &tmpCtx.publicKeyContext.publicKey, tmpCtx.publicKeyContext.rawAddress, tmpCtx.publicKeyContext.chainCode);
+  }
+  // The checksummed string is only needed when returned or displayed
+  if (!(p2 & (P2_RAW_ADDRESS | P2_KEY_ONLY)) || (p1 == P1_CONFIRM)) {
+    getCachedAddressString(tmpCtx.publicKeyContext.rawAddress, tmpCtx.publicKeyContext.address);
+  }
 #ifndef NO_CONSENT
   if (p1 == P1_NON_CONFIRM)
 #endif // NO_CONSENT
@@ -218,69 +253,210 @@ void handleGetPublicKey(uint8_t p1, uint8_t p2, uint8_t *dataBuffer, uint16_t da
 #ifndef NO_CONSENT
   else {
     // prepare for a UI based reply
-    snprintf(strings.common.fullAddress, sizeof(strings.common.fullAddress), "0x%.*s", 40, tmpCtx.publicKeyContext.address);
+    snprintf(strings.common.display, sizeof(strings.common.display), "0x%.*s", 40, tmpCtx.publicKeyContext.address);
     ux_flow_init(0, ux_display_public_flow, NULL);
     *flags |= IO_ASYNCH_REPLY;
   }
 #endif // NO_CONSENT
 }
 
-void handleProvideErc20TokenInformation(uint8_t p1, uint8_t p2, uint8_t *workBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx) {
-  UNUSED(p1);
-  UNUSED(p2);
+void handleGetAddresses(uint8_t p1, uint8_t p2, uint8_t *dataBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx) {
   UNUSED(flags);
-  UNUSED(tx);
-  uint32_t offset = 0;
-  uint8_t tickerLength;
-  uint8_t hash[32];
-  cx_ecfp_public_key_t tokenKey;
+  uint8_t privateKeyData[32];
+  uint8_t chainCode[32];
+  uint8_t publicKey[33];
+  uint8_t childKeyData[32];
+  uint8_t childChainCode[32];
+  bip32Path_t derivationPath;
+  cx_ecfp_private_key_t privateKey;
+  uint32_t offset;
+  uint32_t index;
+  uint8_t count;
 
+  reset_app_context();
+  if ((p1 != 0) || (p2 != 0)) {
+    THROW(0x6B00);
+  }
+  if (parse_bip32_path(&derivationPath, dataBuffer, dataLength)) {
+    PRINTF("Invalid path\n");
+    THROW(0x6a80);
+  }
+  // Room for the child index in the full path
+  if (derivationPath.len == MAX_BIP32_PATH) {
+    THROW(0x6a80);
+  }
+  offset = 1 + derivationPath.len * sizeof(uint32_t);
+  if (dataLength != offset + 4 + 1) {
+    THROW(0x6700);
+  }
+  index = U4BE(dataBuffer, offset);
+  count = dataBuffer[offset + 4];
+  if ((count == 0) || (count > MAX_BATCH_ADDRESSES) ||
+      (index >= BIP32_HARDENED) || (index + count > BIP32_HARDENED)) {
+    THROW(0x6a80);
+  }
 
-  tmpCtx.transactionContext.currentTokenIndex = (tmpCtx.transactionContext.currentTokenIndex + 1) % MAX_TOKEN;
-  tokenDefinition_t* token = &tmpCtx.transactionContext.tokens[tmpCtx.transactionContext.currentTokenIndex];
+  io_seproxyhal_io_heartbeat();
+  deriveNode(&derivationPath, privateKeyData, chainCode);
+  io_seproxyhal_io_heartbeat();
+  bip32GetCompressedPublicKey(privateKeyData, publicKey);
+  for (uint8_t i = 0; i < count; i++, index++) {
+    memcpy(childKeyData, privateKeyData, 32);
+    memcpy(childChainCode, chainCode, 32);
+    io_seproxyhal_io_heartbeat();
+    if (!bip32DeriveChild(childKeyData, childChainCode, publicKey, index)) {
+      derivationPath.path[derivationPath.len] = index;
+      os_perso_derive_node_bip32(CX_CURVE_256K1, derivationPath.path, derivationPath.len + 1, childKeyData, NULL);
+    }
+    cx_ecfp_init_private_key(CX_CURVE_256K1, childKeyData, 32, &privateKey);
+    io_seproxyhal_io_heartbeat();
+    cx_ecfp_generate_pair(CX_CURVE_256K1, &tmpCtx.publicKeyContext.publicKey, &privateKey, 1);
+    getEthAddressFromKey(&tmpCtx.publicKeyContext.publicKey, G_io_apdu_buffer + 20 * i, &sha3);
+  }
+  explicit_bzero(&privateKey, sizeof(privateKey));
+  explicit_bzero(privateKeyData, sizeof(privateKeyData));
+  explicit_bzero(chainCode, sizeof(chainCode));
+  explicit_bzero(childKeyData, sizeof(childKeyData));
+  explicit_bzero(childChainCode, sizeof(childChainCode));
+  *tx = 20 * count;
+  THROW(0x9000);
+}
 
-  PRINTF("Provisioning currentTokenIndex %d\n", tmpCtx.transactionContext.currentTokenIndex);
+// Parses a token descriptor (ticker length, ticker, address, decimals and
+// chain ID) and returns its length
+static uint32_t parseTokenDescriptor(const uint8_t *workBuffer, uint16_t dataLength, tokenDefinition_t *token) {
+  uint32_t offset = 0;
+  uint8_t tickerLength;
 
+  // Cleared so that descriptors compare equal to the registered ones
+  memset(token, 0, sizeof(tokenDefinition_t));
   if (dataLength < 1) {
     THROW(0x6A80);
   }
   tickerLength = workBuffer[offset++];
-  dataLength--;
   // We need to make sure we can write the ticker, a space and a zero byte at the end
   if ((tickerLength + 2) >= sizeof(token->ticker)) {
     THROW(0x6A80);
   }
-  if (dataLength < tickerLength + 20 + 4 + 4) {
+  if (dataLength < 1 + tickerLength + 20 + 4 + 4) {
     THROW(0x6A80);
   }
-  cx_hash_sha256(workBuffer + offset, tickerLength + 20 + 4 + 4, hash, 32);
   memcpy(token->ticker, workBuffer + offset, tickerLength);
   token->ticker[tickerLength] = ' ';
   token->ticker[tickerLength + 1] = '\0';
   offset += tickerLength;
-  dataLength -= tickerLength;
   memcpy(token->address, workBuffer + offset, 20);
   offset += 20;
-  dataLength -= 20;
   token->decimals = U4BE(workBuffer, offset);
   offset += 4;
-  dataLength -= 4;
-
   // Skip chainId
   offset += 4;
-  dataLength -= 4;
-  cx_ecfp_init_public_key(CX_CURVE_256K1, TOKEN_SIGNATURE_PUBLIC_KEY, sizeof(TOKEN_SIGNATURE_PUBLIC_KEY), &tokenKey);
-  if (!cx_ecdsa_verify(&tokenKey, CX_LAST, CX_SHA256, hash, 32, workBuffer + offset, dataLength)) {
-    PRINTF("Invalid token signature\n");
+  return offset;
+}
+
+void handleProvideErc20TokenInformation(uint8_t p1, uint8_t p2, uint8_t *workBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx) {
+  UNUSED(p1);
+  UNUSED(p2);
+  UNUSED(flags);
+  UNUSED(tx);
+  uint32_t offset;
+  uint8_t hash[32];
+  cx_ecfp_public_key_t tokenKey;
+  const tokenDefinition_t *known;
+  tokenDefinition_t token;
+
+  offset = parseTokenDescriptor(workBuffer, dataLength, &token);
+  // A descriptor identical to a cached or known one was already verified
+  known = lookupCachedToken(token.address);
+  if ((known == NULL) || (memcmp(known, &token, sizeof(tokenDefinition_t)) != 0)) {
+    known = lookupRegisteredToken(token.address);
+  }
+  if ((known == NULL) || (memcmp(known, &token, sizeof(tokenDefinition_t)) != 0)) {
+    cx_hash_sha256(workBuffer + 1, offset - 1, hash, 32);
+    cx_ecfp_init_public_key(CX_CURVE_256K1, TOKEN_SIGNATURE_PUBLIC_KEY, sizeof(TOKEN_SIGNATURE_PUBLIC_KEY), &tokenKey);
+    if (!cx_ecdsa_verify(&tokenKey, CX_LAST, CX_SHA256, hash, 32, workBuffer + offset, dataLength - offset)) {
+      PRINTF("Invalid token signature\n");
+      THROW(0x6A80);
+    }
+  }
+  // Nothing is written if the descriptor is already saved
+  registerToken(&token);
+  cacheToken(&token);
+  THROW(0x9000);
+}
+
+void handleProvideMetadata(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx) {
+  UNUSED(flags);
+  UNUSED(tx);
+  uint8_t hash[32];
+  cx_sha256_t sha256;
+  cx_ecfp_public_key_t tokenKey;
+  tokenDefinition_t token;
+  uint8_t recordLength;
+  uint8_t depth;
+  uint32_t index;
+
+  if (p2 != 0) {
+    THROW(0x6B00);
+  }
+  switch (p1) {
+    case P1_METADATA_ROOT:
+      if (dataLength < 32) {
+        THROW(0x6700);
+      }
+      cx_sha256_init(&sha256);
+      cx_hash((cx_hash_t *)&sha256, 0, (uint8_t *)METADATA_ROOT_MAGIC, sizeof(METADATA_ROOT_MAGIC) - 1, NULL, 0);
+      cx_hash((cx_hash_t *)&sha256, CX_LAST, (uint8_t *)workBuffer, 32, hash, 32);
+      cx_ecfp_init_public_key(CX_CURVE_256K1, TOKEN_SIGNATURE_PUBLIC_KEY, sizeof(TOKEN_SIGNATURE_PUBLIC_KEY), &tokenKey);
+      if (!cx_ecdsa_verify(&tokenKey, CX_LAST, CX_SHA256, hash, 32, (uint8_t *)workBuffer + 32, dataLength - 32)) {
+        PRINTF("Invalid metadata signature\n");
+        THROW(0x6A80);
+      }
+      metadataSetRoot(workBuffer);
+      THROW(0x9000);
+    case P1_METADATA_RECORD:
+      break;
+    default:
+      THROW(0x6B00);
+  }
+
+  if ((dataLength < 2) || (dataLength < 2 + workBuffer[1] + 4 + 1)) {
+    THROW(0x6700);
+  }
+  recordLength = workBuffer[1];
+  index = U4BE(workBuffer, 2 + recordLength);
+  depth = workBuffer[2 + recordLength + 4];
+  if ((depth > METADATA_MAX_DEPTH) || (dataLength != 2 + recordLength + 4 + 1 + 32 * depth)) {
     THROW(0x6A80);
   }
-  tmpCtx.transactionContext.tokenSet[tmpCtx.transactionContext.currentTokenIndex] = 1;
+  if (!metadataVerify(workBuffer[0], workBuffer + 2, recordLength, index, workBuffer + 2 + recordLength + 4 + 1, depth)) {
+    PRINTF("Invalid metadata proof\n");
+    THROW(0x6A80);
+  }
+  switch (workBuffer[0]) {
+    case METADATA_RECORD_TOKEN:
+      if (parseTokenDescriptor(workBuffer + 2, recordLength, &token) != recordLength) {
+        THROW(0x6A80);
+      }
+      registerToken(&token);
+      cacheToken(&token);
+      break;
+    default:
+      THROW(0x6A80);
+  }
   THROW(0x9000);
 }
 
 void handleSign(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx) {
   UNUSED(tx);
   parserStatus_e txResult;
+  // Checked before any state change
+  if ((p1 != P1_FIRST) && (p1 != P1_MORE)) {
+    THROW(0x6B00);
+  }
+  if (p2 & ~(P2_RECOVERY_ID | P2_FULL_V)) {
+    THROW(0x6B00);
+  }
   if (p1 == P1_FIRST) {
     if (appState != APP_STATE_IDLE) {
       reset_app_context();
@@ -296,20 +472,22 @@ void handleSign(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t data
     appState = APP_STATE_SIGNING_TX;
     dataPresent = false;
     tokenProvisioned = false;
+    prefetchedAddresses = 0;
+    reviewExactAmounts = false;
     //0x8000003c is the Ethereum path
     initTx(&txContext, &sha3, &tmpContent.txContent, customProcessor, tmpCtx.transactionContext.derivationPath.path[1] == 0x8000003c, NULL);
+    tmpCtx.transactionContext.responseFlags = p2;
   }
   else
-  if (p1 != P1_MORE) {
-    THROW(0x6B00);
-  }
-  if (p2 != 0) {
-    THROW(0x6B00);
-  }
-  if ((p1 == P1_MORE) && (appState != APP_STATE_SIGNING_TX)) {
+  if (appState != APP_STATE_SIGNING_TX) {
     PRINTF("Signature not initialized\n");
     THROW(0x6985);
   }
+  else
+  // The response options are given with the first chunk, and may be repeated
+  if ((p2 != 0) && (p2 != tmpCtx.transactionContext.responseFlags)) {
+    THROW(0x6B00);
+  }
   if (txContext.currentField == TX_RLP_NONE) {
     PRINTF("Parser not initialized\n");
     THROW(0x6985);
@@ -405,14 +583,18 @@ void handleSignPersonalMessage(uint8_t p1, uint8_t p2, uint8_t *workBuffer, uint
     }
     tmp[pos] = '\0';
     cx_hash((cx_hash_t *)&sha3, 0, (uint8_t*)tmp, pos, NULL, 0);
-    cx_sha256_init(&tmpContent.sha2);
   }
   else if (p1 != P1_MORE) {
     THROW(0x6B00);
   }
-  if (p2 != 0) {
+  // The response options are given with the first chunk, and may be repeated
+  if ((p2 & ~(P2_RECOVERY_ID | P2_FULL_V)) ||
+      ((p1 == P1_MORE) && (p2 != 0) && (p2 != tmpCtx.messageSigningContext.responseFlags))) {
     THROW(0x6B00);
   }
+  if (p1 == P1_FIRST) {
+    tmpCtx.messageSigningContext.responseFlags = p2;
+  }
   if ((p1 == P1_MORE) && (appState != APP_STATE_SIGNING_MESSAGE)) {
     PRINTF("Signature not initialized\n");
     THROW(0x6985);
@@ -421,20 +603,19 @@ void handleSignPersonalMessage(uint8_t p1, uint8_t p2, uint8_t *workBuffer, uint
       THROW(0x6A80);
   }
   cx_hash((cx_hash_t *)&sha3, 0, workBuffer, dataLength, NULL, 0);
-  cx_hash((cx_hash_t *)&tmpContent.sha2, 0, workBuffer, dataLength, NULL, 0);
   tmpCtx.messageSigningContext.remainingLength -= dataLength;
   if (tmpCtx.messageSigningContext.remainingLength == 0) {
-    uint8_t hashMessage[32];
+    // The fingerprint shown is taken from the hash being signed
+    const uint8_t *hashMessage = tmpCtx.messageSigningContext.hash;
 
     cx_hash((cx_hash_t *)&sha3, CX_LAST, workBuffer, 0, tmpCtx.messageSigningContext.hash, 32);
-    cx_hash((cx_hash_t *)&tmpContent.sha2, CX_LAST, workBuffer, 0, hashMessage, 32);
 
 #define HASH_LENGTH 4
-    array_hexstr(strings.common.fullAddress, hashMessage, HASH_LENGTH / 2);
-    strings.common.fullAddress[HASH_LENGTH / 2 * 2] = '.';
-    strings.common.fullAddress[HASH_LENGTH / 2 * 2 + 1] = '.';
-    strings.common.fullAddress[HASH_LENGTH / 2 * 2 + 2] = '.';
-    array_hexstr(strings.common.fullAddress + HASH_LENGTH / 2 * 2 + 3, hashMessage + 32 - HASH_LENGTH / 2, HASH_LENGTH / 2);
+    hexEncode(hashMessage, HASH_LENGTH / 2, strings.common.display);
+    strings.common.display[HASH_LENGTH / 2 * 2] = '.';
+    strings.common.display[HASH_LENGTH / 2 * 2 + 1] = '.';
+    strings.common.display[HASH_LENGTH / 2 * 2 + 2] = '.';
+    hexEncode(hashMessage + 32 - HASH_LENGTH / 2, HASH_LENGTH / 2, strings.common.display + HASH_LENGTH / 2 * 2 + 3);
 
 #ifdef NO_CONSENT
     io_seproxyhal_touch_signMessage_ok(NULL);
@@ -449,6 +630,41 @@ void handleSignPersonalMessage(uint8_t p1, uint8_t p2, uint8_t *workBuffer, uint
   }
 }
 
+void handleSignTypedData(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx) {
+  UNUSED(tx);
+  if (p1 == P1_TYPED_DATA_START) {
+    if (appState != APP_STATE_IDLE) {
+      reset_app_context();
+    }
+    typedDataInit();
+    if (p2 & ~(P2_RECOVERY_ID | P2_FULL_V)) {
+      THROW(0x6B00);
+    }
+    if (parse_bip32_path(&tmpCtx.typedDataContext.derivationPath, workBuffer, dataLength)) {
+      PRINTF("Invalid path\n");
+      THROW(0x6a80);
+    }
+    tmpCtx.typedDataContext.responseFlags = p2;
+    appState = APP_STATE_SIGNING_TYPED_DATA;
+    THROW(0x9000);
+  }
+  if (appState != APP_STATE_SIGNING_TYPED_DATA) {
+    PRINTF("Signature not initialized\n");
+    THROW(0x6985);
+  }
+  if (!typedDataProcess(p1, p2, workBuffer, dataLength)) {
+    THROW(0x9000);
+  }
+
+#ifdef NO_CONSENT
+  io_seproxyhal_touch_signTypedData_ok(NULL);
+#else
+  ux_flow_init(0, ux_sign_typed_data_flow, NULL);
+#endif // NO_CONSENT
+
+  *flags |= IO_ASYNCH_REPLY;
+}
+
 void handleApdu(volatile unsigned int *flags, volatile unsigned int *tx) {
   unsigned short sw = 0;
 
@@ -470,7 +686,6 @@ void handleApdu(volatile unsigned int *flags, volatile unsigned int *tx) {
 
       switch (G_io_apdu_buffer[OFFSET_INS]) {
         case INS_GET_PUBLIC_KEY:
-          memset(tmpCtx.transactionContext.tokenSet, 0, MAX_TOKEN);
           handleGetPublicKey(G_io_apdu_buffer[OFFSET_P1], G_io_apdu_buffer[OFFSET_P2], G_io_apdu_buffer + OFFSET_CDATA, G_io_apdu_buffer[OFFSET_LC], flags, tx);
           break;
 
@@ -487,7 +702,6 @@ void handleApdu(volatile unsigned int *flags, volatile unsigned int *tx) {
           break;
 
         case INS_SIGN_PERSONAL_MESSAGE:
-          memset(tmpCtx.transactionContext.tokenSet, 0, MAX_TOKEN);
           handleSignPersonalMessage(G_io_apdu_buffer[OFFSET_P1], G_io_apdu_buffer[OFFSET_P2], G_io_apdu_buffer + OFFSET_CDATA, G_io_apdu_buffer[OFFSET_LC], flags, tx);
           break;
 
@@ -495,6 +709,26 @@ void handleApdu(volatile unsigned int *flags, volatile unsigned int *tx) {
 	  handleGetAppType(G_io_apdu_buffer[OFFSET_P1], G_io_apdu_buffer[OFFSET_P2], G_io_apdu_buffer + OFFSET_CDATA, G_io_apdu_buffer[OFFSET_LC], flags, tx);
 	  break;
 
+        case INS_GET_ADDRESSES:
+          handleGetAddresses(G_io_apdu_buffer[OFFSET_P1], G_io_apdu_buffer[OFFSET_P2], G_io_apdu_buffer + OFFSET_CDATA, G_io_apdu_buffer[OFFSET_LC], flags, tx);
+          break;
+
+        case INS_DECLARE_BATCH:
+          handleDeclareBatch(G_io_apdu_buffer[OFFSET_P1], G_io_apdu_buffer[OFFSET_P2], G_io_apdu_buffer + OFFSET_CDATA, G_io_apdu_buffer[OFFSET_LC], flags, tx);
+          break;
+
+        case INS_SET_POLICY:
+          handleSetPolicy(G_io_apdu_buffer[OFFSET_P1], G_io_apdu_buffer[OFFSET_P2], G_io_apdu_buffer + OFFSET_CDATA, G_io_apdu_buffer[OFFSET_LC], flags, tx);
+          break;
+
+        case INS_SIGN_TYPED_DATA:
+          handleSignTypedData(G_io_apdu_buffer[OFFSET_P1], G_io_apdu_buffer[OFFSET_P2], G_io_apdu_buffer + OFFSET_CDATA, G_io_apdu_buffer[OFFSET_LC], flags, tx);
+          break;
+
+        case INS_PROVIDE_METADATA:
+          handleProvideMetadata(G_io_apdu_buffer[OFFSET_P1], G_io_apdu_buffer[OFFSET_P2], G_io_apdu_buffer + OFFSET_CDATA, G_io_apdu_buffer[OFFSET_LC], flags, tx);
+          break;
+
 #if 0
         case 0xFF: // return to dashboard
           goto return_to_dashboard;
@@ -643,6 +877,8 @@ unsigned char io_event(unsigned char channel) {
         break;
 
     case SEPROXYHAL_TAG_TICKER_EVENT:
+        sessionTick();
+        policyTick();
         UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {});
         break;
     }
@@ -660,6 +896,7 @@ void app_exit(void) {
 
     BEGIN_TRY_L(exit) {
         TRY_L(exit) {
+            sessionWipe();
             os_sched_exit(-1);
         }
         FINALLY_L(exit) {
@@ -674,7 +911,6 @@ __attribute__((section(".boot"))) int main(void) {
     __asm volatile("cpsie i");
 
     reset_app_context();
-    tmpCtx.transactionContext.currentTokenIndex = 0;
 
     // ensure exception will work as planned
     os_boot();
@@ -695,6 +931,8 @@ __attribute__((section(".boot"))) int main(void) {
                   internalStorage_t storage;
                   storage.dataAllowed = 0x01;
                   storage.contractDetails = 0x00;
+                  storage.compactAmounts = 0x00;
+                  storage.sessionCache = 0x00;
                   storage.initialized = 0x01;
                   nvm_write(&N_storage, (void*)&storage, sizeof(internalStorage_t));
                 }
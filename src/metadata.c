@@ -0,0 +1,54 @@
+#include "metadata.h"
+
+#include "os.h"
+#include "cx.h"
+
+#include <string.h>
+
+#define LEAF_PREFIX 0x00
+#define NODE_PREFIX 0x01
+
+static uint8_t metadataRoot[32];
+static bool metadataRootSet;
+
+void metadataSetRoot(const uint8_t *root) {
+  memcpy(metadataRoot, root, 32);
+  metadataRootSet = true;
+}
+
+bool metadataVerify(uint8_t type, const uint8_t *record, uint8_t recordLength,
+                    uint32_t index, const uint8_t *siblings, uint8_t depth) {
+  cx_sha256_t sha256;
+  uint8_t hash[32];
+  uint8_t prefix[2];
+
+  // Index bits above the depth would make several proofs valid for a leaf
+  if (!metadataRootSet || (depth > METADATA_MAX_DEPTH) || ((index >> depth) != 0)) {
+    return false;
+  }
+  prefix[0] = LEAF_PREFIX;
+  prefix[1] = type;
+  cx_sha256_init(&sha256);
+  cx_hash((cx_hash_t *)&sha256, 0, prefix, 2, NULL, 0);
+  cx_hash((cx_hash_t *)&sha256, CX_LAST, record, recordLength, hash, 32);
+  prefix[0] = NODE_PREFIX;
+  for (uint8_t i = 0; i < depth; i++, index >>= 1) {
+    const uint8_t *sibling = siblings + 32 * i;
+    cx_sha256_init(&sha256);
+    cx_hash((cx_hash_t *)&sha256, 0, prefix, 1, NULL, 0);
+    if (index & 1) {
+      cx_hash((cx_hash_t *)&sha256, 0, sibling, 32, NULL, 0);
+      cx_hash((cx_hash_t *)&sha256, CX_LAST, hash, 32, hash, 32);
+    }
+    else {
+      cx_hash((cx_hash_t *)&sha256, 0, hash, 32, NULL, 0);
+      cx_hash((cx_hash_t *)&sha256, CX_LAST, sibling, 32, hash, 32);
+    }
+  }
+  return (memcmp(hash, metadataRoot, 32) == 0);
+}
+
+void metadataWipe(void) {
+  explicit_bzero(metadataRoot, sizeof(metadataRoot));
+  metadataRootSet = false;
+}
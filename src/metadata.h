@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Metadata authenticated by a Merkle tree: the host provides a signed root
+// once, then records with their inclusion proof, which only cost hashing.
+// Leaves are SHA-256(0x00 || record type || record) and nodes are
+// SHA-256(0x01 || left || right).
+
+#define METADATA_RECORD_TOKEN 0x00
+
+// Records fit one APDU with their proof
+#define METADATA_MAX_DEPTH 6
+
+// Prefix of the signed message, SHA-256 of the prefix and the root. It is
+// longer than any token descriptor, so neither signature can stand for the
+// other.
+#define METADATA_ROOT_MAGIC "Celo metadata root"
+
+void metadataSetRoot(const uint8_t *root);
+
+// True if the record is the leaf at index of the current root, given the
+// depth sibling hashes of its path, from the leaf up
+bool metadataVerify(uint8_t type, const uint8_t *record, uint8_t recordLength,
+                    uint32_t index, const uint8_t *siblings, uint8_t depth);
+
+void metadataWipe(void);
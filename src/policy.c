@@ -0,0 +1,397 @@
+#include "policy.h"
+
+#include "os.h"
+#include "ux.h"
+
+#include "address_cache.h"
+#include "celo.h"
+#include "globals.h"
+#include "hexUtils.h"
+#include "ui_flow.h"
+#include "uint256.h"
+#include "utils.h"
+
+#include <string.h>
+
+#define P1_POLICY_FIRST 0x00
+#define P1_POLICY_MORE 0x80
+#define P1_POLICY_DISABLE 0x01
+
+// One week
+#define POLICY_MAX_WINDOW_SECONDS 604800
+
+const policy_t N_policy_real;
+#define N_policy (*(policy_t*) PIC(&N_policy_real))
+
+// Amounts signed without review, per limit and slice of the rolling window.
+// The device has no clock, so the window is measured in uptime: after the
+// application starts, nothing is signed without review until a full window
+// has elapsed. One slice more than the window holds is kept so that an
+// amount is only released once a full window has passed.
+#define SPENT_SLICES (POLICY_WINDOW_BUCKETS + 1)
+static uint256_t windowSpent[POLICY_MAX_TOKENS][SPENT_SLICES];
+static uint8_t currentBucket;
+static uint32_t bucketTicks;
+static uint32_t activeTicks;
+
+static uint8_t receivedDestinations;
+// Entry of each list shown in the review
+static uint8_t reviewIndexes[POLICY_FIELD_RECIPIENT + 1];
+
+static void clearWindow(void) {
+  memset(windowSpent, 0, sizeof(windowSpent));
+  currentBucket = 0;
+  bucketTicks = 0;
+}
+
+void policyTick(void) {
+  const policy_t *policy = &N_policy;
+  uint32_t bucketLength;
+  if (!policy->enabled) {
+    return;
+  }
+  if (activeTicks < policy->windowTicks) {
+    activeTicks++;
+  }
+  bucketLength = policy->windowTicks / POLICY_WINDOW_BUCKETS;
+  if (++bucketTicks >= bucketLength) {
+    bucketTicks = 0;
+    currentBucket = (currentBucket + 1) % SPENT_SLICES;
+    for (uint8_t i = 0; i < POLICY_MAX_TOKENS; i++) {
+      clear256(&windowSpent[i][currentBucket]);
+    }
+  }
+}
+
+static bool listContains(const uint8_t *list, uint8_t count, uint8_t entryLength, const uint8_t *entry) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (memcmp(list + i * entryLength, entry, entryLength) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static int8_t findLimit(const policy_t *policy, const uint8_t *currency) {
+  for (uint8_t i = 0; i < policy->limitCount; i++) {
+    if (memcmp(policy->limits[i].token, currency, 20) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Adds an amount to what the transaction charges to a limit, false on overflow
+static bool charge(uint256_t *charged, const uint256_t *amount) {
+  add256(charged, amount, charged);
+  // Carry out of the addition
+  return gte256(charged, amount);
+}
+
+bool policyAuthorize(void) {
+  const policy_t *policy = &N_policy;
+  const txContent_t *content = &tmpContent.txContent;
+  const tokenDefinition_t *token = tmpCtx.transactionContext.amountToken;
+  const uint8_t *currency = (token != NULL ? token->address : NATIVE_CURRENCY);
+  const uint8_t *feeCurrency = (content->feeCurrencyLength != 0 ? content->feeCurrency : NATIVE_CURRENCY);
+  // Value and maximum fee charged to each limit
+  uint256_t charged[POLICY_MAX_TOKENS];
+  uint256_t amount, limit, spent;
+  int8_t valueIndex, feeIndex;
+
+  if (!policy->enabled || (activeTicks < policy->windowTicks) ||
+      (content->destinationLength == 0) ||
+      !listContains(&policy->destinations[0][0], policy->destinationCount, 20, content->destination) ||
+      // The gateway fee goes to the gateway destination
+      ((content->gatewayDestinationLength != 0) &&
+       !listContains(&policy->destinations[0][0], policy->destinationCount, 20, content->gatewayDestination)) ||
+      !listContains(&policy->feeCurrencies[0][0], policy->feeCurrencyCount, 20, feeCurrency) ||
+      (dataPresent && !listContains(&policy->selectors[0][0], policy->selectorCount, 4,
+                                    tmpCtx.transactionContext.selector))) {
+    return false;
+  }
+  valueIndex = findLimit(policy, currency);
+  feeIndex = findLimit(policy, feeCurrency);
+  if ((valueIndex < 0) || (feeIndex < 0)) {
+    return false;
+  }
+  memset(charged, 0, sizeof(charged));
+  convertUint256BE(content->value.value, content->value.length, &charged[valueIndex]);
+  if (!getMaxFee(content, &amount) || !charge(&charged[feeIndex], &amount)) {
+    return false;
+  }
+  for (uint8_t index = 0; index < policy->limitCount; index++) {
+    readu256BE(policy->limits[index].perTransaction, &limit);
+    if (gt256(&charged[index], &limit)) {
+      return false;
+    }
+    copy256(&spent, &charged[index]);
+    for (uint8_t i = 0; i < SPENT_SLICES; i++) {
+      if (!charge(&spent, &windowSpent[index][i])) {
+        return false;
+      }
+    }
+    readu256BE(policy->limits[index].perWindow, &limit);
+    if (gt256(&spent, &limit)) {
+      PRINTF("Rolling limit reached\n");
+      return false;
+    }
+  }
+  for (uint8_t index = 0; index < policy->limitCount; index++) {
+    add256(&windowSpent[index][currentBucket], &charged[index], &windowSpent[index][currentBucket]);
+  }
+  return true;
+}
+
+static int reviewPrefix(policyField_e field, uint8_t count, char *out, size_t outLength) {
+  return snprintf(out, outLength, "%d/%d ", reviewIndexes[field] + 1, count);
+}
+
+void formatPolicyField(policyField_e field) {
+  const policy_t *policy = &tmpCtx.policyContext;
+  char *out = strings.common.display;
+  size_t outLength = sizeof(strings.common.display);
+  uint8_t index = reviewIndexes[field];
+  uint256_t amount;
+  int offset;
+
+  switch (field) {
+    case POLICY_FIELD_WINDOW:
+      snprintf(out, outLength, "%u seconds", (unsigned int)(policy->windowTicks / POLICY_TICKS_PER_SECOND));
+      break;
+    case POLICY_FIELD_TRANSACTION_LIMIT:
+    case POLICY_FIELD_WINDOW_LIMIT:
+      offset = reviewPrefix(field, policy->limitCount, out, outLength);
+      readu256BE((field == POLICY_FIELD_TRANSACTION_LIMIT ? policy->limits[index].perTransaction
+                                                          : policy->limits[index].perWindow), &amount);
+      amountToString(&amount, policy->limits[index].ticker, policy->limits[index].decimals,
+                     out + offset, outLength - offset);
+      break;
+    case POLICY_FIELD_FEE_CURRENCY:
+      offset = reviewPrefix(field, policy->feeCurrencyCount, out, outLength);
+      if (memcmp(policy->feeCurrencies[index], NATIVE_CURRENCY, 20) == 0) {
+        strcpy(out + offset, CHAINID_COINNAME);
+      }
+      else {
+        out[offset++] = '0';
+        out[offset++] = 'x';
+        getCachedAddressString(policy->feeCurrencies[index], out + offset);
+      }
+      break;
+    case POLICY_FIELD_SELECTOR:
+      if (policy->selectorCount == 0) {
+        strcpy(out, "None");
+        break;
+      }
+      offset = reviewPrefix(field, policy->selectorCount, out, outLength);
+      out[offset++] = '0';
+      out[offset++] = 'x';
+      hexEncodeLowercase(policy->selectors[index], 4, out + offset);
+      break;
+    case POLICY_FIELD_RECIPIENT:
+      offset = reviewPrefix(field, policy->destinationCount, out, outLength);
+      out[offset++] = '0';
+      out[offset++] = 'x';
+      getCachedAddressString(policy->destinations[index], out + offset);
+      break;
+  }
+}
+
+void policyNextEntry(policyField_e field) {
+  const policy_t *policy = &tmpCtx.policyContext;
+  uint8_t count = 1;
+  switch (field) {
+    case POLICY_FIELD_TRANSACTION_LIMIT:
+    case POLICY_FIELD_WINDOW_LIMIT:
+      count = policy->limitCount;
+      break;
+    case POLICY_FIELD_FEE_CURRENCY:
+      count = policy->feeCurrencyCount;
+      break;
+    case POLICY_FIELD_SELECTOR:
+      count = (policy->selectorCount != 0 ? policy->selectorCount : 1);
+      break;
+    case POLICY_FIELD_RECIPIENT:
+      count = policy->destinationCount;
+      break;
+    default:
+      break;
+  }
+  reviewIndexes[field] = (reviewIndexes[field] + 1) % count;
+  ux_flow_relayout();
+}
+
+void policyApprove(void) {
+  if (appState != APP_STATE_SETTING_POLICY) {
+    return;
+  }
+  tmpCtx.policyContext.enabled = 1;
+  // The only NVM write of a policy change
+  nvm_write(&N_policy, (void*)&tmpCtx.policyContext, sizeof(policy_t));
+  reset_app_context();
+  // Nothing was signed under the new policy yet
+  clearWindow();
+  activeTicks = N_policy.windowTicks;
+}
+
+void policyReject(void) {
+  reset_app_context();
+}
+
+// Checks that the limits can be displayed, they are rendered at review time
+static bool limitsFit(void) {
+  const policy_t *policy = &tmpCtx.policyContext;
+  char text[sizeof(strings.common.display)];
+  uint256_t amount;
+  // Room for the "i/n " index prefix
+  const size_t textLength = sizeof(text) - 4;
+  for (uint8_t i = 0; i < policy->limitCount; i++) {
+    readu256BE(policy->limits[i].perTransaction, &amount);
+    if (!amountToString(&amount, policy->limits[i].ticker, policy->limits[i].decimals, text, textLength)) {
+      return false;
+    }
+    readu256BE(policy->limits[i].perWindow, &amount);
+    if (!amountToString(&amount, policy->limits[i].ticker, policy->limits[i].decimals, text, textLength)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads a count followed by that many entries of the pending policy
+static uint8_t parseList(const uint8_t *workBuffer, uint16_t dataLength, uint16_t *offset,
+                         uint8_t maxCount, uint8_t entryLength, void *target, uint8_t *countTarget) {
+  uint8_t count;
+  if (dataLength < *offset + 1) {
+    THROW(0x6700);
+  }
+  count = workBuffer[(*offset)++];
+  if (count > maxCount) {
+    THROW(0x6A80);
+  }
+  if (dataLength < *offset + count * entryLength) {
+    THROW(0x6700);
+  }
+  *countTarget = count;
+  memcpy(target, workBuffer + *offset, count * entryLength);
+  *offset += count * entryLength;
+  return count;
+}
+
+static void parseHeader(const uint8_t *workBuffer, uint16_t dataLength, uint16_t *offset) {
+  policy_t *pending = &tmpCtx.policyContext;
+  policyLimit_t *limit;
+  uint32_t windowSeconds;
+  uint8_t count;
+
+  if (dataLength < 4 + 1) {
+    THROW(0x6700);
+  }
+  windowSeconds = U4BE(workBuffer, 0);
+  count = workBuffer[4];
+  if ((windowSeconds == 0) || (windowSeconds > POLICY_MAX_WINDOW_SECONDS) ||
+      (count == 0) || (count > POLICY_MAX_TOKENS)) {
+    THROW(0x6A80);
+  }
+  memset(pending, 0, sizeof(policy_t));
+  pending->windowTicks = windowSeconds * POLICY_TICKS_PER_SECOND;
+  pending->limitCount = count;
+  *offset = 4 + 1;
+  for (uint8_t i = 0; i < count; i++) {
+    if (dataLength < *offset + 20 + 32 + 32) {
+      THROW(0x6700);
+    }
+    limit = &pending->limits[i];
+    memcpy(limit->token, workBuffer + *offset, 20);
+    memcpy(limit->perTransaction, workBuffer + *offset + 20, 32);
+    memcpy(limit->perWindow, workBuffer + *offset + 20 + 32, 32);
+    *offset += 20 + 32 + 32;
+    if (!lookupCurrency(limit->token, limit->ticker, &limit->decimals)) {
+      PRINTF("Unknown currency\n");
+      THROW(0x6A80);
+    }
+    for (uint8_t j = 0; j < i; j++) {
+      if (memcmp(pending->limits[j].token, limit->token, 20) == 0) {
+        THROW(0x6A80);
+      }
+    }
+  }
+  if (parseList(workBuffer, dataLength, offset, POLICY_MAX_FEE_CURRENCIES, 20,
+                pending->feeCurrencies, &pending->feeCurrencyCount) == 0) {
+    THROW(0x6A80);
+  }
+  // Fees are charged to the limits of their currency
+  for (uint8_t i = 0; i < pending->feeCurrencyCount; i++) {
+    if (findLimit(pending, pending->feeCurrencies[i]) < 0) {
+      THROW(0x6A80);
+    }
+  }
+  parseList(workBuffer, dataLength, offset, POLICY_MAX_SELECTORS, 4,
+            pending->selectors, &pending->selectorCount);
+  if (dataLength < *offset + 1) {
+    THROW(0x6700);
+  }
+  count = workBuffer[(*offset)++];
+  if ((count == 0) || (count > POLICY_MAX_DESTINATIONS)) {
+    THROW(0x6A80);
+  }
+  pending->destinationCount = count;
+}
+
+void handleSetPolicy(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx) {
+  UNUSED(tx);
+  policy_t *pending = &tmpCtx.policyContext;
+  uint16_t offset = 0;
+  uint8_t count;
+  uint8_t zero = 0;
+
+  if (p2 != 0) {
+    THROW(0x6B00);
+  }
+  switch (p1) {
+    case P1_POLICY_DISABLE:
+      // Reducing what is signed without review needs no confirmation
+      if (appState == APP_STATE_SETTING_POLICY) {
+        reset_app_context();
+      }
+      nvm_write(&N_policy.enabled, &zero, sizeof(uint8_t));
+      clearWindow();
+      THROW(0x9000);
+    case P1_POLICY_FIRST:
+      // The pending policy is declared in tmpCtx, and only written to NVM
+      // once approved
+      reset_app_context();
+      receivedDestinations = 0;
+      parseHeader(workBuffer, dataLength, &offset);
+      appState = APP_STATE_SETTING_POLICY;
+      break;
+    case P1_POLICY_MORE:
+      if ((appState != APP_STATE_SETTING_POLICY) || (receivedDestinations == pending->destinationCount)) {
+        THROW(0x6985);
+      }
+      break;
+    default:
+      THROW(0x6B00);
+  }
+
+  count = (dataLength - offset) / 20;
+  if ((count * 20 != dataLength - offset) ||
+      (receivedDestinations + count > pending->destinationCount)) {
+    reset_app_context();
+    THROW(0x6A80);
+  }
+  memcpy(pending->destinations[receivedDestinations], workBuffer + offset, count * 20);
+  receivedDestinations += count;
+  if (receivedDestinations < pending->destinationCount) {
+    THROW(0x9000);
+  }
+
+  if (!limitsFit()) {
+    reset_app_context();
+    PRINTF("Amount too large to display\n");
+    THROW(0x6A80);
+  }
+  memset(reviewIndexes, 0, sizeof(reviewIndexes));
+  ux_flow_init(0, ux_approval_policy_flow, NULL);
+  *flags |= IO_ASYNCH_REPLY;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Signing policy: limits configured once with an on-device confirmation and
+// kept in NVM. Transactions that comply are signed without review, the others
+// go through the usual review.
+
+#ifndef POLICY_MAX_TOKENS
+#define POLICY_MAX_TOKENS 2
+#endif
+
+#ifndef POLICY_MAX_FEE_CURRENCIES
+#define POLICY_MAX_FEE_CURRENCIES 2
+#endif
+
+#ifndef POLICY_MAX_SELECTORS
+#define POLICY_MAX_SELECTORS 4
+#endif
+
+#ifndef POLICY_MAX_DESTINATIONS
+#define POLICY_MAX_DESTINATIONS 8
+#endif
+
+// The rolling window is tracked in this many slices
+#ifndef POLICY_WINDOW_BUCKETS
+#define POLICY_WINDOW_BUCKETS 4
+#endif
+
+// UX ticker events per second
+#define POLICY_TICKS_PER_SECOND 10
+
+typedef struct policyLimit_t {
+  // Zero for the native currency
+  uint8_t token[20];
+  char ticker[10];
+  uint8_t decimals;
+  // Big endian amounts
+  uint8_t perTransaction[32];
+  uint8_t perWindow[32];
+} policyLimit_t;
+
+typedef struct policy_t {
+  uint8_t enabled;
+  uint32_t windowTicks;
+  uint8_t limitCount;
+  policyLimit_t limits[POLICY_MAX_TOKENS];
+  uint8_t feeCurrencyCount;
+  uint8_t feeCurrencies[POLICY_MAX_FEE_CURRENCIES][20];
+  uint8_t selectorCount;
+  uint8_t selectors[POLICY_MAX_SELECTORS][4];
+  uint8_t destinationCount;
+  uint8_t destinations[POLICY_MAX_DESTINATIONS][20];
+} policy_t;
+
+typedef enum {
+  POLICY_FIELD_WINDOW,
+  POLICY_FIELD_TRANSACTION_LIMIT,
+  POLICY_FIELD_WINDOW_LIMIT,
+  POLICY_FIELD_FEE_CURRENCY,
+  POLICY_FIELD_SELECTOR,
+  POLICY_FIELD_RECIPIENT
+} policyField_e;
+
+void handleSetPolicy(uint8_t p1, uint8_t p2, const uint8_t *workBuffer, uint16_t dataLength, volatile unsigned int *flags, volatile unsigned int *tx);
+
+// Checks the parsed transaction against the policy, and charges its amount
+// and maximum fee to the rolling window if it complies
+bool policyAuthorize(void);
+
+// Called on every ticker event, to age the rolling window
+void policyTick(void);
+
+// Renders a screen of the policy review into strings.common
+void formatPolicyField(policyField_e field);
+// Shows the next entry of a list of the review
+void policyNextEntry(policyField_e field);
+
+// Called when the user approves or rejects the pending policy
+void policyApprove(void);
+void policyReject(void);
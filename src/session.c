@@ -0,0 +1,111 @@
+#include "session.h"
+
+#include "batch.h"
+#include "bip32.h"
+#include "key_cache.h"
+#include "metadata.h"
+#include "signature_cache.h"
+
+#include "os.h"
+#include "cx.h"
+#include "os_io_seproxyhal.h"
+
+#include <string.h>
+
+typedef struct sessionNode_t {
+  // Length of the hardened prefix the node was derived from, 0 when empty
+  uint8_t pathLength;
+  uint32_t path[MAX_BIP32_PATH];
+  uint8_t privateKey[32];
+  uint8_t chainCode[32];
+  // Compressed public key, needed by every non hardened child derivation
+  uint8_t publicKey[33];
+} sessionNode_t;
+
+static sessionNode_t sessionNode;
+static uint32_t sessionIdleTicks;
+
+static void wipeNode(void) {
+  explicit_bzero(&sessionNode, sizeof(sessionNode));
+  sessionIdleTicks = 0;
+}
+
+static uint8_t hardenedPrefixLength(const bip32Path_t *path) {
+  uint8_t length = 0;
+  while ((length < path->len) && (path->path[length] & BIP32_HARDENED)) {
+    length++;
+  }
+  return length;
+}
+
+// Derives the non hardened components of path following the cached node.
+// Returns false for the (negligible) invalid child keys, which the full
+// derivation then handles.
+static bool deriveChildren(const bip32Path_t *path, uint8_t *privateKeyData, uint8_t *chainCode) {
+  uint8_t publicKey[33];
+  bool valid = true;
+
+  memcpy(privateKeyData, sessionNode.privateKey, 32);
+  memcpy(chainCode, sessionNode.chainCode, 32);
+  memcpy(publicKey, sessionNode.publicKey, 33);
+  for (uint8_t i = sessionNode.pathLength; valid && (i < path->len); i++) {
+    if (i != sessionNode.pathLength) {
+      io_seproxyhal_io_heartbeat();
+      bip32GetCompressedPublicKey(privateKeyData, publicKey);
+    }
+    valid = bip32DeriveChild(privateKeyData, chainCode, publicKey, path->path[i]);
+  }
+  return valid;
+}
+
+void deriveNode(const bip32Path_t *path, uint8_t *privateKeyData, uint8_t *chainCode) {
+  uint8_t nodeChainCode[32];
+  uint8_t prefixLength = hardenedPrefixLength(path);
+  bool cacheable = N_storage.sessionCache && (prefixLength != 0) && (prefixLength < path->len);
+
+  for (uint8_t i = prefixLength; cacheable && (i < path->len); i++) {
+    cacheable = !(path->path[i] & BIP32_HARDENED);
+  }
+  if (!cacheable) {
+    os_perso_derive_node_bip32(CX_CURVE_256K1, path->path, path->len, privateKeyData, chainCode);
+    return;
+  }
+  if ((sessionNode.pathLength != prefixLength) ||
+      (memcmp(sessionNode.path, path->path, prefixLength * sizeof(uint32_t)) != 0)) {
+    wipeNode();
+    os_perso_derive_node_bip32(CX_CURVE_256K1, path->path, prefixLength, sessionNode.privateKey,
+                               sessionNode.chainCode);
+    io_seproxyhal_io_heartbeat();
+    bip32GetCompressedPublicKey(sessionNode.privateKey, sessionNode.publicKey);
+    memcpy(sessionNode.path, path->path, prefixLength * sizeof(uint32_t));
+    sessionNode.pathLength = prefixLength;
+  }
+  sessionIdleTicks = 0;
+  if (deriveChildren(path, privateKeyData, nodeChainCode)) {
+    if (chainCode != NULL) {
+      memcpy(chainCode, nodeChainCode, 32);
+    }
+  }
+  else {
+    os_perso_derive_node_bip32(CX_CURVE_256K1, path->path, path->len, privateKeyData, chainCode);
+  }
+  explicit_bzero(nodeChainCode, sizeof(nodeChainCode));
+}
+
+void sessionTick(void) {
+  if (os_global_pin_is_validated() != BOLOS_UX_OK) {
+    sessionWipe();
+  }
+  else if ((sessionNode.pathLength != 0) && (++sessionIdleTicks >= SESSION_TIMEOUT_TICKS)) {
+    wipeNode();
+  }
+  signatureCacheTick();
+}
+
+void sessionWipe(void) {
+  wipeNode();
+  keyCacheWipe();
+  signatureCacheWipe();
+  metadataWipe();
+  batchClose();
+}
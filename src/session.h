@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "globals.h"
+
+// Ticker events before an unused session node is wiped, 5 minutes at the
+// 100 ms UX ticker period
+#ifndef SESSION_TIMEOUT_TICKS
+#define SESSION_TIMEOUT_TICKS 3000
+#endif
+
+// Derives the private key of path into privateKeyData (32 bytes), and its
+// chain code if chainCode is not NULL.
+// When the session cache setting is enabled, the node of the hardened prefix
+// of the path (the account node, 44'/52752'/0' for instance) is kept in RAM
+// and the non hardened children are derived from it, instead of deriving the
+// full path from the seed every time.
+void deriveNode(const bip32Path_t *path, uint8_t *privateKeyData, uint8_t *chainCode);
+
+// Called on every ticker event. Wipes the session when the device is locked,
+// and the cached node when it has not been used for SESSION_TIMEOUT_TICKS.
+void sessionTick(void);
+
+// Wipes the cached node, the key cache, the last signature and the metadata
+// root and ends any batch, on lock, exit or when the setting is disabled
+void sessionWipe(void);
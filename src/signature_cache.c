@@ -0,0 +1,45 @@
+#include "signature_cache.h"
+
+#include "os.h"
+
+#include <string.h>
+
+typedef struct signatureCache_t {
+  // Ticks left before the entry expires, 0 when empty
+  uint32_t ticks;
+  bip32Path_t path;
+  uint8_t hash[32];
+  uint8_t signature[64];
+  uint8_t recoveryId;
+} signatureCache_t;
+
+static signatureCache_t signatureCache;
+
+void storeSignature(const bip32Path_t *path, const uint8_t *hash, const uint8_t *signature, uint8_t recoveryId) {
+  memcpy(&signatureCache.path, path, sizeof(bip32Path_t));
+  memcpy(signatureCache.hash, hash, 32);
+  memcpy(signatureCache.signature, signature, sizeof(signatureCache.signature));
+  signatureCache.recoveryId = recoveryId;
+  signatureCache.ticks = SIGNATURE_CACHE_TICKS;
+}
+
+bool lookupSignature(const bip32Path_t *path, const uint8_t *hash, uint8_t *signature, uint8_t *recoveryId) {
+  if ((signatureCache.ticks == 0) || (signatureCache.path.len != path->len) ||
+      (memcmp(signatureCache.path.path, path->path, path->len * sizeof(uint32_t)) != 0) ||
+      (memcmp(signatureCache.hash, hash, 32) != 0)) {
+    return false;
+  }
+  memcpy(signature, signatureCache.signature, sizeof(signatureCache.signature));
+  *recoveryId = signatureCache.recoveryId;
+  return true;
+}
+
+void signatureCacheTick(void) {
+  if ((signatureCache.ticks != 0) && (--signatureCache.ticks == 0)) {
+    signatureCacheWipe();
+  }
+}
+
+void signatureCacheWipe(void) {
+  explicit_bzero(&signatureCache, sizeof(signatureCache));
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "globals.h"
+
+// Ticker events the last transaction signature is kept for, 1 minute at the
+// 100 ms UX ticker period
+#ifndef SIGNATURE_CACHE_TICKS
+#define SIGNATURE_CACHE_TICKS 600
+#endif
+
+// v, r and s of a transaction signature as returned to the host
+#define SIGNATURE_RESPONSE_LENGTH 65
+
+// Keeps r and s (64 bytes) and the recovery ID of the last signed
+// transaction, so that a transaction resent after the link dropped is
+// answered without a second review
+void storeSignature(const bip32Path_t *path, const uint8_t *hash, const uint8_t *signature, uint8_t recoveryId);
+
+// Copies r, s and the recovery ID if the transaction hash was signed with the
+// same path within the last SIGNATURE_CACHE_TICKS
+bool lookupSignature(const bip32Path_t *path, const uint8_t *hash, uint8_t *signature, uint8_t *recoveryId);
+
+// Called on every ticker event, to expire the signature
+void signatureCacheTick(void);
+
+void signatureCacheWipe(void);
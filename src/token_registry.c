@@ -0,0 +1,61 @@
+#include "token_registry.h"
+
+#include "os.h"
+
+#include <string.h>
+
+typedef struct tokenRegistry_t {
+  uint8_t count;
+  // Slot written next once the registry is full
+  uint8_t next;
+  tokenDefinition_t tokens[TOKEN_REGISTRY_SIZE];
+} tokenRegistry_t;
+
+const tokenRegistry_t N_tokenRegistry_real;
+#define N_tokenRegistry (*(tokenRegistry_t*) PIC(&N_tokenRegistry_real))
+
+static int8_t findToken(const uint8_t *address) {
+  for (uint8_t i = 0; i < MIN(N_tokenRegistry.count, TOKEN_REGISTRY_SIZE); i++) {
+    if (memcmp(N_tokenRegistry.tokens[i].address, address, 20) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const tokenDefinition_t *lookupRegisteredToken(const uint8_t *address) {
+  int8_t index = findToken(address);
+  return (index < 0 ? NULL : &N_tokenRegistry.tokens[index]);
+}
+
+void registerToken(const tokenDefinition_t *token) {
+  int8_t index = findToken(token->address);
+  uint8_t value;
+
+  if (index >= 0) {
+    if (memcmp(&N_tokenRegistry.tokens[index], token, sizeof(tokenDefinition_t)) != 0) {
+      nvm_write(&N_tokenRegistry.tokens[index], (void*)token, sizeof(tokenDefinition_t));
+    }
+    return;
+  }
+  if (N_tokenRegistry.count < TOKEN_REGISTRY_SIZE) {
+    index = N_tokenRegistry.count;
+    nvm_write(&N_tokenRegistry.tokens[index], (void*)token, sizeof(tokenDefinition_t));
+    value = index + 1;
+    nvm_write(&N_tokenRegistry.count, &value, sizeof(uint8_t));
+    return;
+  }
+  index = N_tokenRegistry.next % TOKEN_REGISTRY_SIZE;
+  nvm_write(&N_tokenRegistry.tokens[index], (void*)token, sizeof(tokenDefinition_t));
+  value = (index + 1) % TOKEN_REGISTRY_SIZE;
+  nvm_write(&N_tokenRegistry.next, &value, sizeof(uint8_t));
+}
+
+uint8_t registeredTokenCount(void) {
+  return MIN(N_tokenRegistry.count, TOKEN_REGISTRY_SIZE);
+}
+
+void clearTokenRegistry(void) {
+  // A NULL source erases the destination
+  nvm_write(&N_tokenRegistry, NULL, sizeof(tokenRegistry_t));
+}
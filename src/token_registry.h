@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tokens.h"
+
+// Token descriptors whose signature was verified, kept in NVM so that the
+// tokens known once are recognized in later sessions without being
+// provided and verified again.
+
+#ifndef TOKEN_REGISTRY_SIZE
+#define TOKEN_REGISTRY_SIZE 16
+#endif
+
+// Registered descriptor of a token address, NULL if unknown
+const tokenDefinition_t *lookupRegisteredToken(const uint8_t *address);
+
+// Saves a verified descriptor. The oldest one is replaced when the registry
+// is full, and nothing is written if the descriptor is already saved.
+void registerToken(const tokenDefinition_t *token);
+
+uint8_t registeredTokenCount(void);
+void clearTokenRegistry(void);
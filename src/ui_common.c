@@ -3,6 +3,10 @@
 #include "celo.h"
 #include "os_io_seproxyhal.h" // for heartbeat
 #include "globals.h"
+#include "session.h"
+#include "batch.h"
+#include "policy.h"
+#include "signature_cache.h"
 #include "utils.h"
 
 unsigned int io_seproxyhal_touch_data_ok(const bagl_element_t *e) {
@@ -76,12 +80,9 @@ unsigned int io_seproxyhal_touch_tx_ok(const bagl_element_t *e) {
     uint8_t privateKeyData[32];
     uint8_t signature[100];
     cx_ecfp_private_key_t privateKey;
-    uint32_t tx = 0;
-    uint32_t v = getV(&tmpContent.txContent);
+    uint8_t recoveryId;
     io_seproxyhal_io_heartbeat();
-    os_perso_derive_node_bip32(CX_CURVE_256K1, tmpCtx.transactionContext.derivationPath.path,
-                               tmpCtx.transactionContext.derivationPath.len,
-                               privateKeyData, NULL);
+    deriveNode(&tmpCtx.transactionContext.derivationPath, privateKeyData, NULL);
     cx_ecfp_init_private_key(CX_CURVE_256K1, privateKeyData, 32,
                                  &privateKey);
     explicit_bzero(privateKeyData, sizeof(privateKeyData));
@@ -91,29 +92,12 @@ unsigned int io_seproxyhal_touch_tx_ok(const bagl_element_t *e) {
                   tmpCtx.transactionContext.hash,
                   sizeof(tmpCtx.transactionContext.hash), signature, sizeof(signature), &info);
     explicit_bzero(&privateKey, sizeof(privateKey));
-    // Parity is present in the sequence tag in the legacy API
-    if (tmpContent.txContent.vLength == 0) {
-      // Legacy API
-      G_io_apdu_buffer[0] = 27;
-    }
-    else {
-      // New API
-      // Note that this is wrong for a large v, but the client can always recover
-      G_io_apdu_buffer[0] = (v * 2) + 35;
-    }
-    if (info & CX_ECCINFO_PARITY_ODD) {
-      G_io_apdu_buffer[0]++;
-    }
-    if (info & CX_ECCINFO_xGTn) {
-      G_io_apdu_buffer[0] += 2;
-    }
+    recoveryId = get_recovery_id(info);
     format_signature_out(signature);
-    tx = 65;
-    G_io_apdu_buffer[tx++] = 0x90;
-    G_io_apdu_buffer[tx++] = 0x00;
-    reset_app_context();
-    // Send back the response, do not restart the event loop
-    io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
+    storeSignature(&tmpCtx.transactionContext.derivationPath, tmpCtx.transactionContext.hash,
+                   G_io_apdu_buffer + 1, recoveryId);
+    send_signature_out(recoveryId, getSignatureV(&tmpContent.txContent, recoveryId),
+                       tmpCtx.transactionContext.responseFlags);
     // Display back the original UX
     ui_idle();
     return 0; // do not redraw the widget
@@ -131,39 +115,76 @@ unsigned int io_seproxyhal_touch_tx_cancel(const bagl_element_t *e) {
     return 0; // do not redraw the widget
 }
 
-unsigned int io_seproxyhal_touch_signMessage_ok(const bagl_element_t *e) {
+unsigned int io_seproxyhal_touch_batch_ok(const bagl_element_t *e) {
+    UNUSED(e);
+    batchApprove();
+    io_seproxyhal_send_status(0x9000);
+    // Display back the original UX
+    ui_idle();
+    return 0; // do not redraw the widget
+}
+
+unsigned int io_seproxyhal_touch_batch_cancel(const bagl_element_t *e) {
+    UNUSED(e);
+    batchClose();
+    io_seproxyhal_send_status(0x6985);
+    // Display back the original UX
+    ui_idle();
+    return 0; // do not redraw the widget
+}
+
+unsigned int io_seproxyhal_touch_policy_ok(const bagl_element_t *e) {
+    UNUSED(e);
+    policyApprove();
+    io_seproxyhal_send_status(0x9000);
+    // Display back the original UX
+    ui_idle();
+    return 0; // do not redraw the widget
+}
+
+unsigned int io_seproxyhal_touch_policy_cancel(const bagl_element_t *e) {
     UNUSED(e);
+    policyReject();
+    io_seproxyhal_send_status(0x6985);
+    // Display back the original UX
+    ui_idle();
+    return 0; // do not redraw the widget
+}
+
+// Signs a personal message or typed data hash, whose v is 27 or 28
+static void sign_message_hash(const bip32Path_t *path, const uint8_t *hash, uint8_t responseFlags) {
     uint8_t privateKeyData[32];
     uint8_t signature[100];
     cx_ecfp_private_key_t privateKey;
-    uint32_t tx = 0;
+    uint8_t recoveryId;
     io_seproxyhal_io_heartbeat();
-    os_perso_derive_node_bip32(
-        CX_CURVE_256K1, tmpCtx.messageSigningContext.derivationPath.path,
-        tmpCtx.messageSigningContext.derivationPath.len, privateKeyData, NULL);
+    deriveNode(path, privateKeyData, NULL);
     io_seproxyhal_io_heartbeat();
     cx_ecfp_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &privateKey);
     explicit_bzero(privateKeyData, sizeof(privateKeyData));
     unsigned int info = 0;
     io_seproxyhal_io_heartbeat();
     cx_ecdsa_sign(&privateKey, CX_RND_RFC6979 | CX_LAST, CX_SHA256,
-                  tmpCtx.messageSigningContext.hash,
-                  sizeof(tmpCtx.messageSigningContext.hash), signature, sizeof(signature), &info);
+                  hash, 32, signature, sizeof(signature), &info);
     explicit_bzero(&privateKey, sizeof(privateKey));
-    G_io_apdu_buffer[0] = 27;
-    if (info & CX_ECCINFO_PARITY_ODD) {
-      G_io_apdu_buffer[0]++;
-    }
-    if (info & CX_ECCINFO_xGTn) {
-      G_io_apdu_buffer[0] += 2;
-    }
+    recoveryId = get_recovery_id(info);
     format_signature_out(signature);
-    tx = 65;
-    G_io_apdu_buffer[tx++] = 0x90;
-    G_io_apdu_buffer[tx++] = 0x00;
-    reset_app_context();
-    // Send back the response, do not restart the event loop
-    io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
+    send_signature_out(recoveryId, 27 + (recoveryId & 1), responseFlags);
+}
+
+unsigned int io_seproxyhal_touch_signMessage_ok(const bagl_element_t *e) {
+    UNUSED(e);
+    sign_message_hash(&tmpCtx.messageSigningContext.derivationPath, tmpCtx.messageSigningContext.hash,
+                      tmpCtx.messageSigningContext.responseFlags);
+    // Display back the original UX
+    ui_idle();
+    return 0; // do not redraw the widget
+}
+
+unsigned int io_seproxyhal_touch_signTypedData_ok(const bagl_element_t *e) {
+    UNUSED(e);
+    sign_message_hash(&tmpCtx.typedDataContext.derivationPath, tmpCtx.typedDataContext.hash,
+                      tmpCtx.typedDataContext.responseFlags);
     // Display back the original UX
     ui_idle();
     return 0; // do not redraw the widget
@@ -15,5 +15,11 @@ unsigned int io_seproxyhal_touch_address_cancel(const bagl_element_t *e);
 unsigned int io_seproxyhal_touch_tx_ok(const bagl_element_t *e);
 unsigned int io_seproxyhal_touch_tx_cancel(const bagl_element_t *e);
 
+unsigned int io_seproxyhal_touch_batch_ok(const bagl_element_t *e);
+unsigned int io_seproxyhal_touch_batch_cancel(const bagl_element_t *e);
+unsigned int io_seproxyhal_touch_policy_ok(const bagl_element_t *e);
+unsigned int io_seproxyhal_touch_policy_cancel(const bagl_element_t *e);
+
 unsigned int io_seproxyhal_touch_signMessage_ok(const bagl_element_t *e);
 unsigned int io_seproxyhal_touch_signMessage_cancel(const bagl_element_t *e);
+unsigned int io_seproxyhal_touch_signTypedData_ok(const bagl_element_t *e);
@@ -2,6 +2,13 @@
 
 #include "ui_flow.h"
 #include "globals.h"
+#include "celo.h"
+#include "session.h"
+#include "batch.h"
+#include "policy.h"
+#include "eip712.h"
+#include "tokenCache.h"
+#include "token_registry.h"
 
 ux_state_t G_ux;
 bolos_ux_params_t G_ux_params;
@@ -17,6 +24,11 @@ void ui_idle(void) {
 void display_settings(void);
 void switch_settings_contract_data(void);
 void switch_settings_display_data(void);
+void switch_settings_compact_amounts(void);
+void switch_settings_session_cache(void);
+void clear_settings_tokens(void);
+void app_exit(void);
+void switch_review_exact_amounts(void);
 
 //////////////////////////////////////////////////////////////////////
 UX_STEP_NOCB(
@@ -45,7 +57,7 @@ UX_STEP_CB(
 UX_STEP_CB(
     ux_idle_flow_4_step,
     pb,
-    os_sched_exit(-1),
+    app_exit(),
     {
       &C_icon_dashboard_x,
       "Quit",
@@ -91,6 +103,42 @@ UX_STEP_CB_INIT(
       .text = g_SettingsText,
     });
 
+UX_STEP_CB_INIT(
+    ux_settings_flow_compact_step,
+    bnnn_paging,
+    {
+      const char *text = N_storage.compactAmounts ? "Compact" : "Exact";
+      strlcpy(g_SettingsText, text, SETTINGS_TEXT_SIZE);
+    },
+    switch_settings_compact_amounts(),
+    {
+      .title = "Amounts",
+      .text = g_SettingsText,
+    });
+
+UX_STEP_CB_INIT(
+    ux_settings_flow_session_step,
+    bnnn_paging,
+    {
+      const char *text = N_storage.sessionCache ? "Enabled" : "Disabled";
+      strlcpy(g_SettingsText, text, SETTINGS_TEXT_SIZE);
+    },
+    switch_settings_session_cache(),
+    {
+      .title = "Key cache",
+      .text = g_SettingsText,
+    });
+
+UX_STEP_CB_INIT(
+    ux_settings_flow_tokens_step,
+    bnnn_paging,
+    snprintf(g_SettingsText, SETTINGS_TEXT_SIZE, "%d saved", registeredTokenCount()),
+    clear_settings_tokens(),
+    {
+      .title = "Clear tokens",
+      .text = g_SettingsText,
+    });
+
 #else
 
 UX_STEP_CB_INIT(
@@ -123,6 +171,48 @@ UX_STEP_CB_INIT(
       g_SettingsText
     });
 
+UX_STEP_CB_INIT(
+    ux_settings_flow_compact_step,
+    bnnn,
+    {
+      const char *text = N_storage.compactAmounts ? "Compact" : "Exact";
+      strlcpy(g_SettingsText, text, SETTINGS_TEXT_SIZE);
+    },
+    switch_settings_compact_amounts(),
+    {
+      "Amounts",
+      "Round amounts to",
+      "fit one screen",
+      g_SettingsText
+    });
+
+UX_STEP_CB_INIT(
+    ux_settings_flow_session_step,
+    bnnn,
+    {
+      const char *text = N_storage.sessionCache ? "Enabled" : "Disabled";
+      strlcpy(g_SettingsText, text, SETTINGS_TEXT_SIZE);
+    },
+    switch_settings_session_cache(),
+    {
+      "Key cache",
+      "Keep the account",
+      "key until locked",
+      g_SettingsText
+    });
+
+UX_STEP_CB_INIT(
+    ux_settings_flow_tokens_step,
+    bnnn,
+    snprintf(g_SettingsText, SETTINGS_TEXT_SIZE, "%d saved", registeredTokenCount()),
+    clear_settings_tokens(),
+    {
+      "Clear tokens",
+      "Forget the verified",
+      "token descriptors",
+      g_SettingsText
+    });
+
 #endif
 
 UX_STEP_CB(
@@ -137,6 +227,9 @@ UX_STEP_CB(
 UX_FLOW(ux_settings_flow,
   &ux_settings_flow_1_step,
   &ux_settings_flow_2_step,
+  &ux_settings_flow_compact_step,
+  &ux_settings_flow_session_step,
+  &ux_settings_flow_tokens_step,
   &ux_settings_flow_3_step
 );
 
@@ -156,6 +249,33 @@ void switch_settings_display_data() {
   display_settings();
 }
 
+void switch_settings_compact_amounts() {
+  uint8_t value = (N_storage.compactAmounts ? 0 : 1);
+  nvm_write(&N_storage.compactAmounts, (void*)&value, sizeof(uint8_t));
+  display_settings();
+}
+
+void switch_settings_session_cache() {
+  uint8_t value = (N_storage.sessionCache ? 0 : 1);
+  nvm_write(&N_storage.sessionCache, (void*)&value, sizeof(uint8_t));
+  sessionWipe();
+  display_settings();
+}
+
+void clear_settings_tokens() {
+  clearTokenRegistry();
+  clearTokenCache();
+  display_settings();
+}
+
+// Both buttons on a compact amount show the exact value, and back
+void switch_review_exact_amounts() {
+  if (N_storage.compactAmounts) {
+    reviewExactAmounts = !reviewExactAmounts;
+    ux_flow_relayout();
+  }
+}
+
 //////////////////////////////////////////////////////////////////////
 UX_STEP_NOCB(
     ux_display_public_flow_1_step,
@@ -170,7 +290,7 @@ UX_STEP_NOCB(
     bnnn_paging,
     {
       .title = "Address",
-      .text = strings.common.fullAddress,
+      .text = strings.common.display,
     });
 UX_STEP_CB(
     ux_display_public_flow_3_step,
@@ -289,44 +409,52 @@ UX_STEP_NOCB(ux_approval_tx_1_step,
       "transaction",
     });
 
-UX_STEP_NOCB(
+UX_STEP_CB_INIT(
     ux_approval_tx_2_step,
     bnnn_paging,
+    formatReviewField(REVIEW_AMOUNT),
+    switch_review_exact_amounts(),
     {
       .title = "Amount",
-      .text = strings.common.fullAmount
+      .text = strings.common.display
     });
 
-UX_STEP_NOCB(
+UX_STEP_NOCB_INIT(
     ux_approval_tx_3_step,
     bnnn_paging,
+    formatReviewField(REVIEW_ADDRESS),
     {
       .title = "Address",
-      .text = strings.common.fullAddress,
+      .text = strings.common.display,
     });
 
-UX_STEP_NOCB(
+UX_STEP_CB_INIT(
     ux_approval_tx_4_step,
     bnnn_paging,
+    formatReviewField(REVIEW_MAX_FEE),
+    switch_review_exact_amounts(),
     {
       .title = "Max Fees",
-      .text = strings.common.maxFee,
+      .text = strings.common.display,
     });
 
-UX_STEP_NOCB(
+UX_STEP_CB_INIT(
     ux_celo_approval_tx_gateway_fee_step,
     bnnn_paging,
+    formatReviewField(REVIEW_GATEWAY_FEE),
+    switch_review_exact_amounts(),
     {
       .title = "Gateway Fee",
-      .text = strings.common.gatewayFee,
+      .text = strings.common.display,
     });
 
-UX_STEP_NOCB(
+UX_STEP_NOCB_INIT(
     ux_celo_approval_tx_gateway_address_step,
     bnnn_paging,
+    formatReviewField(REVIEW_GATEWAY_ADDRESS),
     {
       .title = "Gateway Addr",
-      .text = strings.common.fullGatewayAddress,
+      .text = strings.common.display,
     });
 
 UX_STEP_CB(
@@ -412,7 +540,7 @@ UX_STEP_NOCB(
     bnnn_paging,
     {
       .title = "Message hash",
-      .text = strings.common.fullAddress,
+      .text = strings.common.display,
     });
 
 UX_STEP_CB(
@@ -441,3 +569,240 @@ UX_FLOW(ux_sign_flow,
   &ux_sign_flow_3_step,
   &ux_sign_flow_4_step
 );
+
+//////////////////////////////////////////////////////////////////////
+UX_STEP_NOCB(
+    ux_sign_typed_data_flow_1_step,
+    pnn,
+    {
+      &C_icon_certificate,
+      "Sign",
+      "typed data",
+    });
+
+UX_STEP_NOCB_INIT(
+    ux_sign_typed_data_flow_2_step,
+    bnnn_paging,
+    formatTypedDataDomain(),
+    {
+      .title = "Domain hash",
+      .text = strings.common.display,
+    });
+
+// Both buttons on the fields show the next one
+UX_STEP_CB_INIT(
+    ux_sign_typed_data_flow_3_step,
+    bnnn_paging,
+    formatTypedDataField(),
+    typedDataNextField(),
+    {
+      .title = strings.common.title,
+      .text = strings.common.display,
+    });
+
+UX_STEP_NOCB_INIT(
+    ux_sign_typed_data_flow_4_step,
+    bnnn_paging,
+    formatTypedDataHash(),
+    {
+      .title = "Message hash",
+      .text = strings.common.display,
+    });
+
+UX_STEP_CB(
+    ux_sign_typed_data_flow_5_step,
+    pbb,
+    io_seproxyhal_touch_signTypedData_ok(NULL),
+    {
+      &C_icon_validate_14,
+      "Sign",
+      "typed data",
+    });
+
+UX_FLOW(ux_sign_typed_data_flow,
+  &ux_sign_typed_data_flow_1_step,
+  &ux_sign_typed_data_flow_2_step,
+  &ux_sign_typed_data_flow_3_step,
+  &ux_sign_typed_data_flow_4_step,
+  &ux_sign_typed_data_flow_5_step,
+  &ux_sign_flow_4_step
+);
+
+//////////////////////////////////////////////////////////////////////
+UX_STEP_NOCB(
+    ux_approval_batch_flow_1_step,
+    pnn,
+    {
+      &C_icon_eye,
+      "Review",
+      "batch",
+    });
+
+UX_STEP_NOCB_INIT(
+    ux_approval_batch_flow_2_step,
+    bnnn_paging,
+    formatBatchField(BATCH_FIELD_COUNT),
+    {
+      .title = "Transactions",
+      .text = strings.common.display,
+    });
+
+// Both buttons on the totals and recipients show the next one
+UX_STEP_CB_INIT(
+    ux_approval_batch_flow_3_step,
+    bnnn_paging,
+    formatBatchField(BATCH_FIELD_TOTAL),
+    batchNextTotal(),
+    {
+      .title = "Total",
+      .text = strings.common.display,
+    });
+
+UX_STEP_NOCB_INIT(
+    ux_approval_batch_flow_4_step,
+    bnnn_paging,
+    formatBatchField(BATCH_FIELD_MAX_FEE),
+    {
+      .title = "Max Fees each",
+      .text = strings.common.display,
+    });
+
+UX_STEP_CB_INIT(
+    ux_approval_batch_flow_5_step,
+    bnnn_paging,
+    formatBatchField(BATCH_FIELD_RECIPIENT),
+    batchNextRecipient(),
+    {
+      .title = "Recipients",
+      .text = strings.common.display,
+    });
+
+UX_STEP_CB(
+    ux_approval_batch_flow_6_step,
+    pbb,
+    io_seproxyhal_touch_batch_ok(NULL),
+    {
+      &C_icon_validate_14,
+      "Accept",
+      "and send",
+    });
+
+UX_STEP_CB(
+    ux_approval_batch_flow_7_step,
+    pb,
+    io_seproxyhal_touch_batch_cancel(NULL),
+    {
+      &C_icon_crossmark,
+      "Reject",
+    });
+
+UX_FLOW(ux_approval_batch_flow,
+  &ux_approval_batch_flow_1_step,
+  &ux_approval_batch_flow_2_step,
+  &ux_approval_batch_flow_3_step,
+  &ux_approval_batch_flow_4_step,
+  &ux_approval_batch_flow_5_step,
+  &ux_approval_batch_flow_6_step,
+  &ux_approval_batch_flow_7_step
+);
+
+//////////////////////////////////////////////////////////////////////
+UX_STEP_NOCB(
+    ux_approval_policy_flow_1_step,
+    pnn,
+    {
+      &C_icon_eye,
+      "Review",
+      "signing policy",
+    });
+
+UX_STEP_NOCB_INIT(
+    ux_approval_policy_flow_2_step,
+    bnnn_paging,
+    formatPolicyField(POLICY_FIELD_WINDOW),
+    {
+      .title = "Window",
+      .text = strings.common.display,
+    });
+
+// Both buttons on the lists show the next entry
+UX_STEP_CB_INIT(
+    ux_approval_policy_flow_3_step,
+    bnnn_paging,
+    formatPolicyField(POLICY_FIELD_TRANSACTION_LIMIT),
+    policyNextEntry(POLICY_FIELD_TRANSACTION_LIMIT),
+    {
+      .title = "Max per tx",
+      .text = strings.common.display,
+    });
+
+UX_STEP_CB_INIT(
+    ux_approval_policy_flow_4_step,
+    bnnn_paging,
+    formatPolicyField(POLICY_FIELD_WINDOW_LIMIT),
+    policyNextEntry(POLICY_FIELD_WINDOW_LIMIT),
+    {
+      .title = "Max per window",
+      .text = strings.common.display,
+    });
+
+UX_STEP_CB_INIT(
+    ux_approval_policy_flow_5_step,
+    bnnn_paging,
+    formatPolicyField(POLICY_FIELD_FEE_CURRENCY),
+    policyNextEntry(POLICY_FIELD_FEE_CURRENCY),
+    {
+      .title = "Fee currencies",
+      .text = strings.common.display,
+    });
+
+UX_STEP_CB_INIT(
+    ux_approval_policy_flow_6_step,
+    bnnn_paging,
+    formatPolicyField(POLICY_FIELD_SELECTOR),
+    policyNextEntry(POLICY_FIELD_SELECTOR),
+    {
+      .title = "Contract calls",
+      .text = strings.common.display,
+    });
+
+UX_STEP_CB_INIT(
+    ux_approval_policy_flow_7_step,
+    bnnn_paging,
+    formatPolicyField(POLICY_FIELD_RECIPIENT),
+    policyNextEntry(POLICY_FIELD_RECIPIENT),
+    {
+      .title = "Recipients",
+      .text = strings.common.display,
+    });
+
+UX_STEP_CB(
+    ux_approval_policy_flow_8_step,
+    pbb,
+    io_seproxyhal_touch_policy_ok(NULL),
+    {
+      &C_icon_validate_14,
+      "Accept",
+      "and enable",
+    });
+
+UX_STEP_CB(
+    ux_approval_policy_flow_9_step,
+    pb,
+    io_seproxyhal_touch_policy_cancel(NULL),
+    {
+      &C_icon_crossmark,
+      "Reject",
+    });
+
+UX_FLOW(ux_approval_policy_flow,
+  &ux_approval_policy_flow_1_step,
+  &ux_approval_policy_flow_2_step,
+  &ux_approval_policy_flow_3_step,
+  &ux_approval_policy_flow_4_step,
+  &ux_approval_policy_flow_5_step,
+  &ux_approval_policy_flow_6_step,
+  &ux_approval_policy_flow_7_step,
+  &ux_approval_policy_flow_8_step,
+  &ux_approval_policy_flow_9_step
+);
@@ -10,5 +10,8 @@ extern const ux_flow_step_t* const ux_approval_celo_data_warning_gateway_tx_flow
 extern const ux_flow_step_t* const ux_approval_celo_gateway_tx_flow[];
 extern const ux_flow_step_t* const ux_approval_celo_data_warning_tx_flow[];
 extern const ux_flow_step_t* const ux_approval_celo_tx_flow[];
+extern const ux_flow_step_t* const ux_approval_batch_flow[];
+extern const ux_flow_step_t* const ux_approval_policy_flow[];
+extern const ux_flow_step_t* const ux_sign_typed_data_flow[];
 extern const ux_flow_step_t* const ux_sign_flow[];
 extern const ux_flow_step_t* const ux_idle_flow[];
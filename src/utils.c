@@ -19,25 +19,34 @@
 #include <string.h>
 
 #include "ethUstream.h"
+#include "ethUtils.h"
 #include "uint256.h"
+#include "utils.h"
 
-static const char hex_digits[] = {'0', '1', '2', '3', '4', '5', '6', '7',
-                                  '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
-
-void array_hexstr(char *strbuf, const void *bin, size_t len) {
-    while (len--) {
-        *strbuf++ = hex_digits[((*((char *)bin)) >> 4) & 0xF];
-        *strbuf++ = hex_digits[(*((char *)bin)) & 0xF];
-        bin = (const void *)((unsigned int)bin + 1);
+bool amountToString(const uint256_t *amount, const char *ticker, uint8_t decimals, char *out, uint32_t outLength) {
+    // Enough for 2^256 in decimal
+    char digits[80];
+    uint32_t tickerLength = strlen(ticker);
+    if ((tickerLength + 1 >= outLength) || !tostring256(amount, 10, digits, sizeof(digits))) {
+        return false;
     }
-    *strbuf = 0; // EOS
+    memcpy(out, ticker, tickerLength);
+    return adjustDecimals(digits, strlen(digits), out + tickerLength, outLength - tickerLength, decimals);
 }
 
-void convertUint256BE(const uint8_t *data, size_t length, uint256_t *target) {
-    uint8_t tmp[32];
-    memset(tmp, 0, 32);
-    memcpy(tmp + 32 - length, data, length);
-    readu256BE(tmp, target);
+bool getMaxFee(const txContent_t *content, uint256_t *fee) {
+    uint256_t gasPrice, startGas, gatewayFee;
+    if (txIntBits(content->gasprice.value, content->gasprice.length) +
+        txIntBits(content->startgas.value, content->startgas.length) > 256) {
+      return false;
+    }
+    convertUint256BE(content->gasprice.value, content->gasprice.length, &gasPrice);
+    convertUint256BE(content->startgas.value, content->startgas.length, &startGas);
+    convertUint256BE(content->gatewayFee.value, content->gatewayFee.length, &gatewayFee);
+    mul256(&gasPrice, &startGas, fee);
+    add256(fee, &gatewayFee, fee);
+    // Carry out of the addition
+    return gte256(fee, &gatewayFee);
 }
 
 uint32_t getV(txContent_t *txContent) {
@@ -65,3 +74,12 @@ uint32_t getV(txContent_t *txContent) {
     }
     return v;
 }
+
+uint32_t getSignatureV(txContent_t *txContent, uint8_t recoveryId) {
+    // v only carries the parity, x >= n is reported by the recovery id alone
+    if (txContent->vLength == 0) {
+      // Legacy API, parity is present in the sequence tag
+      return 27 + (recoveryId & 1);
+    }
+    return getV(txContent) * 2 + 35 + (recoveryId & 1);
+}
@@ -20,12 +20,18 @@
 
 #include <stdint.h>
 
+#include "txIntUtils.h"
 #include "uint256.h"
 
-void array_hexstr(char *strbuf, const void *bin, size_t len);
+// Ticker followed by the decimal amount, in units of 10^decimals
+bool amountToString(const uint256_t *amount, const char *ticker, uint8_t decimals, char *out, uint32_t outLength);
 
-void convertUint256BE(const uint8_t *data, uint32_t length, uint256_t *target);
+// Maximum fee of a transaction, gas price * start gas + gateway fee, false if
+// it does not fit 256 bits
+bool getMaxFee(const txContent_t *content, uint256_t *fee);
 
 uint32_t getV(txContent_t *txContent);
+// EIP 155 v of a transaction signature, from the parity of the recovery id
+uint32_t getSignatureV(txContent_t *txContent, uint8_t recoveryId);
 
 #endif /* _UTILS_H_ */
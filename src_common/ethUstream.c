@@ -21,10 +21,6 @@
 #include <stdint.h>
 #include <string.h>
 
-#ifdef TESTING
-#define PRINTF(...)
-#endif
-
 static int readTxByte(txContext_t *context, uint8_t *byte) {
     uint8_t data;
 
@@ -38,11 +34,9 @@ static int readTxByte(txContext_t *context, uint8_t *byte) {
     if (context->processingField) {
         context->currentFieldPos++;
     }
-#ifndef TESTING
     if (!(context->processingField && context->fieldSingleByte)) {
         cx_hash((cx_hash_t*)context->sha3, 0, &data, 1, NULL, 0);
     }
-#endif
     if (byte) {
         *byte = data;
     }
@@ -57,11 +51,9 @@ int copyTxData(txContext_t *context, uint8_t *out, size_t length)  {
     if (out != NULL) {
         memcpy(out, context->workBuffer, length);
     }
-#ifndef TESTING
     if (!(context->processingField && context->fieldSingleByte)) {
         cx_hash((cx_hash_t*)context->sha3, 0, context->workBuffer, length, NULL, 0);
     }
-#endif
     context->workBuffer += length;
     context->commandLength -= length;
     if (context->processingField) {
@@ -558,7 +550,5 @@ void initTx(txContext_t *context, cx_sha3_t *sha3, txContent_t *content,
     context->isEthereum = isEthereum;
     context->extra = extra;
     context->currentField = TX_RLP_CONTENT;
-#ifndef TESTING
     cx_keccak_init(context->sha3, 256);
-#endif
 }
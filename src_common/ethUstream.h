@@ -22,12 +22,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#ifdef TESTING
-typedef void * cx_sha3_t;
-#else
 #include "os.h"
 #include "cx.h"
-#endif
 
 #define MAX_INT256 32
 #define MAX_ADDRESS 20
@@ -26,73 +26,29 @@
 #include "os.h"
 #include "cx.h"
 #include "ethUtils.h"
+#include "hexUtils.h"
 
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
-#ifdef CHECKSUM_1
-
-static const uint8_t const HEXDIGITS[] = "0123456789ABCDEF";
-
-static const uint8_t const MASK[] = {0x80, 0x40, 0x20, 0x10,
-                                     0x08, 0x04, 0x02, 0x01};
-
-char convertDigit(uint8_t *address, uint8_t index, uint8_t *hash) {
-    unsigned char digit = address[index / 2];
-    if ((index % 2) == 0) {
-        digit = (digit >> 4) & 0x0f;
-    } else {
-        digit = digit & 0x0f;
-    }
-    if (digit < 10) {
-        return HEXDIGITS[digit];
-    } else {
-        unsigned char data = hash[index / 8];
-        if (((data & MASK[index % 8]) != 0) && (digit > 9)) {
-            return HEXDIGITS[digit] /*- 'a' + 'A'*/;
-        } else {
-            return HEXDIGITS[digit];
-        }
-    }
-}
-
-void getEthAddressStringFromKey(const cx_ecfp_public_key_t *publicKey, char *out,
-                                cx_sha3_t *sha3Context) {
+void getEthAddressFromKey(const cx_ecfp_public_key_t *publicKey, uint8_t *out, cx_sha3_t *sha3Context) {
     uint8_t hashAddress[32];
     cx_keccak_init(sha3Context, 256);
     cx_hash((cx_hash_t*)sha3Context, CX_LAST, publicKey->W + 1, 64, hashAddress, 32);
-    getEthAddressStringFromBinary(hashAddress + 12, out, sha3Context);
+    memcpy(out, hashAddress + 12, 20);
 }
 
-void getEthAddressStringFromBinary(const uint8_t *address, uint8_t *out,
-                                   cx_sha3_t *sha3Context) {
-    uint8_t hashChecksum[32];
-    uint8_t i;
-    cx_keccak_init(sha3Context, 256);
-    cx_hash((cx_hash_t*)sha3Context, CX_LAST, address, 20, hashChecksum, 32);
-    for (i = 0; i < 40; i++) {
-        out[i] = convertDigit(address, i, hashChecksum);
-    }
-    out[40] = '\0';
-}
-
-#else
-
-static const uint8_t HEXDIGITS[] = "0123456789abcdef";
-
 void getEthAddressStringFromKey(const cx_ecfp_public_key_t *publicKey, char *out, int chainId, cx_sha3_t *sha3Context) {
-    uint8_t hashAddress[32];
-    cx_keccak_init(sha3Context, 256);
-    cx_hash((cx_hash_t*)sha3Context, CX_LAST, publicKey->W + 1, 64, hashAddress, 32);
-    getEthAddressStringFromBinary(hashAddress + 12, out, chainId, sha3Context);
+    uint8_t address[20];
+    getEthAddressFromKey(publicKey, address, sha3Context);
+    getEthAddressStringFromBinary(address, out, chainId, sha3Context);
 }
 
 void getEthAddressStringFromBinary(const uint8_t *address, char *out, int chainId, cx_sha3_t *sha3Context) {
     uint8_t hashChecksum[32];
     char tmp[100];
-    uint8_t i;
     bool eip1191 = false;
     uint32_t offset = 0;
 
@@ -106,38 +62,12 @@ void getEthAddressStringFromBinary(const uint8_t *address, char *out, int chainI
         snprintf(tmp, sizeof(tmp), "%d0x", chainId);
         offset = strlen(tmp);
     }
-    for (i = 0; i < 20; i++) {
-        uint8_t digit = address[i];
-        tmp[offset + 2 * i] = HEXDIGITS[(digit >> 4) & 0x0f];
-        tmp[offset + 2 * i + 1] = HEXDIGITS[digit & 0x0f];
-    }
+    hexEncodeLowercase(address, 20, tmp + offset);
     cx_keccak_init(sha3Context, 256);
     cx_hash((cx_hash_t*)sha3Context, CX_LAST, (uint8_t *) tmp, offset + 40, hashChecksum, 32);
-    for (i = 0; i < 40; i++) {
-        uint8_t digit = address[i / 2];
-        if ((i % 2) == 0) {
-            digit = (digit >> 4) & 0x0f;
-        } else {
-            digit = digit & 0x0f;
-        }
-        if (digit < 10) {
-            out[i] = HEXDIGITS[digit];
-        }
-        else {
-            int v = (hashChecksum[i / 2] >> (4 * (1 - i % 2))) & 0x0f;
-            if (v >= 8) {
-                out[i] = HEXDIGITS[digit] - 'a' + 'A';
-            }
-            else {
-                out[i] = HEXDIGITS[digit];
-            }
-        }
-    }
-    out[40] = '\0';
+    hexEncodeChecksum(address, 20, hashChecksum, out);
 }
 
-#endif
-
 bool adjustDecimals(const char *src, size_t srcLength, char *target,
                     size_t targetLength, uint8_t decimals) {
     uint32_t startOffset;
@@ -201,3 +131,33 @@ bool adjustDecimals(const char *src, size_t srcLength, char *target,
     }
     return true;
 }
+
+bool truncateDecimals(char *amount, uint8_t maxDigits) {
+    char *point = strchr(amount, '.');
+    uint32_t significant = 0;
+    char *end;
+    if (point == NULL) {
+        return false;
+    }
+    for (end = amount; *end != '\0'; end++) {
+        if ((end == point) || ((significant == 0) && (*end == '0'))) {
+            continue;
+        }
+        significant++;
+        if ((significant > maxDigits) && (end > point)) {
+            break;
+        }
+    }
+    if (*end == '\0') {
+        return false;
+    }
+    // Trailing zeros were already removed, so a non zero digit is dropped
+    while ((end[-1] == '0') && (end - 1 > point)) {
+        end--;
+    }
+    if (end - 1 == point) {
+        end--;
+    }
+    *end = '\0';
+    return true;
+}
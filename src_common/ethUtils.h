@@ -23,6 +23,9 @@
 
 #include "cx.h"
 
+void getEthAddressFromKey(const cx_ecfp_public_key_t *publicKey, uint8_t *out,
+                          cx_sha3_t *sha3Context);
+
 void getEthAddressStringFromKey(const cx_ecfp_public_key_t *publicKey, char *out, int chainId,
                                 cx_sha3_t *sha3Context);
 
@@ -32,4 +35,9 @@ void getEthAddressStringFromBinary(const uint8_t *address, char *out, int chainI
 bool adjustDecimals(const char *src, size_t srcLength, char *target,
                     size_t targetLength, uint8_t decimals);
 
+// Drops the fractional digits of an adjustDecimals result past maxDigits
+// significant digits, the integer part is always kept. Returns true if the
+// value was truncated.
+bool truncateDecimals(char *amount, uint8_t maxDigits);
+
 #endif /* _ETHUTILS_H_ */
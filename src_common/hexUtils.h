@@ -0,0 +1,44 @@
+/*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef _HEXUTILS_H_
+#define _HEXUTILS_H_
+
+#include <stdint.h>
+
+// Two uppercase characters for each byte value. Lowercase is obtained by
+// setting 0x20, which leaves the decimal digits unchanged.
+extern const char HEX_PAIRS[512];
+
+// Lowercase digit for a value below 16
+static inline char hexDigit(uint8_t value) {
+    return HEX_PAIRS[2 * value + 1] | 0x20;
+}
+
+// The encoders write 2 * length characters followed by a terminating zero
+
+void hexEncode(const uint8_t *data, uint32_t length, char *out);
+
+void hexEncodeLowercase(const uint8_t *data, uint32_t length, char *out);
+
+// Mixed case encoding as defined by EIP-55: a letter is uppercase when the
+// matching nibble of hash, the Keccak hash of the lowercase encoding, is 8 or
+// more
+void hexEncodeChecksum(const uint8_t *data, uint32_t length,
+                       const uint8_t *hash, char *out);
+
+#endif /* _HEXUTILS_H_ */
@@ -0,0 +1,118 @@
+/*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "tokenCache.h"
+
+#include <string.h>
+
+#if (TOKEN_CACHE_SIZE & (TOKEN_CACHE_SIZE - 1)) || (TOKEN_CACHE_SIZE > 128)
+#error "TOKEN_CACHE_SIZE must be a power of two, up to 128"
+#endif
+
+#define SLOT_MASK (TOKEN_CACHE_SLOTS - 1)
+
+static tokenDefinition_t tokenCache[TOKEN_CACHE_SIZE];
+// Index of a descriptor plus one, 0 for an empty slot
+static uint8_t tokenCacheSlots[TOKEN_CACHE_SLOTS];
+// Indexes of the descriptors, most recently used first
+static uint8_t tokenCacheOrder[TOKEN_CACHE_SIZE];
+static uint8_t tokenCacheCount;
+
+// Contract addresses are hashes, their last byte is uniformly distributed
+static uint8_t homeSlot(const uint8_t *address) {
+    return address[19] & SLOT_MASK;
+}
+
+// Slot of the address, or the empty slot that ends its probe chain. At most
+// half of the slots are used, so there is one.
+static uint8_t findSlot(const uint8_t *address) {
+    uint8_t slot = homeSlot(address);
+    while ((tokenCacheSlots[slot] != 0) &&
+           (memcmp(tokenCache[tokenCacheSlots[slot] - 1].address, address, 20) != 0)) {
+        slot = (slot + 1) & SLOT_MASK;
+    }
+    return slot;
+}
+
+// Empties a slot, moving back the slots of the probe chain that follows so
+// that none of them is separated from its home slot by an empty slot
+static void removeSlot(uint8_t slot) {
+    uint8_t next = slot;
+    for (;;) {
+        next = (next + 1) & SLOT_MASK;
+        if (tokenCacheSlots[next] == 0) {
+            break;
+        }
+        // The slot can fill the hole if the hole is on its probe chain
+        if (((next - homeSlot(tokenCache[tokenCacheSlots[next] - 1].address)) & SLOT_MASK) >=
+            ((next - slot) & SLOT_MASK)) {
+            tokenCacheSlots[slot] = tokenCacheSlots[next];
+            slot = next;
+        }
+    }
+    tokenCacheSlots[slot] = 0;
+}
+
+// Moves a descriptor index to the front of the use order
+static void touch(uint8_t index) {
+    uint8_t i = 0;
+    while ((i < tokenCacheCount) && (tokenCacheOrder[i] != index)) {
+        i++;
+    }
+    memmove(tokenCacheOrder + 1, tokenCacheOrder, i);
+    tokenCacheOrder[0] = index;
+}
+
+tokenDefinition_t *lookupCachedToken(const uint8_t *address) {
+    uint8_t slot = findSlot(address);
+    if (tokenCacheSlots[slot] == 0) {
+        return NULL;
+    }
+    touch(tokenCacheSlots[slot] - 1);
+    return &tokenCache[tokenCacheSlots[slot] - 1];
+}
+
+tokenDefinition_t *cacheToken(const tokenDefinition_t *token) {
+    uint8_t slot = findSlot(token->address);
+    uint8_t index;
+    if (tokenCacheSlots[slot] != 0) {
+        index = tokenCacheSlots[slot] - 1;
+    }
+    else {
+        if (tokenCacheCount < TOKEN_CACHE_SIZE) {
+            // Last in the use order, until touched below
+            index = tokenCacheCount;
+            tokenCacheOrder[tokenCacheCount++] = index;
+        }
+        else {
+            index = tokenCacheOrder[TOKEN_CACHE_SIZE - 1];
+            removeSlot(findSlot(tokenCache[index].address));
+            // The chain of the new token may go through the removed slot
+            slot = findSlot(token->address);
+        }
+        tokenCacheSlots[slot] = index + 1;
+    }
+    memcpy(&tokenCache[index], token, sizeof(tokenDefinition_t));
+    touch(index);
+    return &tokenCache[index];
+}
+
+void clearTokenCache(void) {
+    memset(tokenCache, 0, sizeof(tokenCache));
+    memset(tokenCacheSlots, 0, sizeof(tokenCacheSlots));
+    tokenCacheCount = 0;
+}
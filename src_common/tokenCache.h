@@ -0,0 +1,52 @@
+/*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef _TOKENCACHE_H_
+#define _TOKENCACHE_H_
+
+#include <stdint.h>
+
+#include "tokens.h"
+
+// Verified token descriptors kept in RAM for the lifetime of the application.
+// Descriptors are found through a table of slots, open addressed on the token
+// address with linear probing. The least recently used descriptor is replaced
+// once the cache is full, its slot being removed with backward shift
+// deletion.
+
+// Number of descriptors
+#ifndef TOKEN_CACHE_SIZE
+#ifdef TARGET_NANOS
+#define TOKEN_CACHE_SIZE 16
+#else
+#define TOKEN_CACHE_SIZE 64
+#endif
+#endif
+
+// Number of slots, half of them stay empty to end the probes
+#define TOKEN_CACHE_SLOTS (2 * TOKEN_CACHE_SIZE)
+
+// Cached descriptor of a token address, NULL if unknown
+tokenDefinition_t *lookupCachedToken(const uint8_t *address);
+
+// Caches a verified descriptor, replacing the one of the same address, and
+// returns the cached copy
+tokenDefinition_t *cacheToken(const tokenDefinition_t *token);
+
+void clearTokenCache(void);
+
+#endif /* _TOKENCACHE_H_ */
@@ -0,0 +1,42 @@
+/*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "tokensList.h"
+
+#include "os.h"
+
+#include <string.h>
+
+#include "tokensTable.h"
+
+const tokenDefinition_t *getBuiltinToken(const uint8_t *address) {
+    uint32_t word = address[TOKENS_HASH_OFFSET] |
+                    (address[TOKENS_HASH_OFFSET + 1] << 8) |
+                    (address[TOKENS_HASH_OFFSET + 2] << 16) |
+                    ((uint32_t)address[TOKENS_HASH_OFFSET + 3] << 24);
+    uint8_t slot = TOKENS_SLOTS[(uint32_t)(word * TOKENS_HASH_MULTIPLIER) >> (32 - TOKENS_HASH_BITS)];
+    const tokenDefinition_t *token;
+    if (slot == 0) {
+        return NULL;
+    }
+    token = (const tokenDefinition_t *)PIC(&TOKENS_LIST[slot - 1]);
+    // Other addresses may share the slot
+    if (memcmp(token->address, address, 20) != 0) {
+        return NULL;
+    }
+    return token;
+}
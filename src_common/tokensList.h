@@ -0,0 +1,30 @@
+/*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef _TOKENSLIST_H_
+#define _TOKENSLIST_H_
+
+#include <stdint.h>
+
+#include "tokens.h"
+
+// Core tokens built into the application, generated from tokens/tokens.json.
+// Returns the descriptor of a token address in constant time, NULL if the
+// address is not built in.
+const tokenDefinition_t *getBuiltinToken(const uint8_t *address);
+
+#endif /* _TOKENSLIST_H_ */
@@ -0,0 +1,16 @@
+// Generated by tokens/generate_tokens.py from tokens/tokens.json, do not edit
+
+#define TOKENS_COUNT 4
+#define TOKENS_HASH_OFFSET 0
+#define TOKENS_HASH_MULTIPLIER 0xcc623a9bu
+#define TOKENS_HASH_BITS 2
+
+static const tokenDefinition_t TOKENS_LIST[TOKENS_COUNT] = {
+    { { 0x47, 0x1e, 0xce, 0x37, 0x50, 0xda, 0x23, 0x7f, 0x93, 0xb8, 0xe3, 0x39, 0xc5, 0x36, 0x98, 0x9b, 0x89, 0x78, 0xa4, 0x38 }, "CELO ", 18 },
+    { { 0x76, 0x5d, 0xe8, 0x16, 0x84, 0x58, 0x61, 0xe7, 0x5a, 0x25, 0xfc, 0xa1, 0x22, 0xbb, 0x68, 0x98, 0xb8, 0xb1, 0x28, 0x2a }, "cUSD ", 18 },
+    { { 0xd8, 0x76, 0x3c, 0xba, 0x27, 0x6a, 0x37, 0x38, 0xe6, 0xde, 0x85, 0xb4, 0xb3, 0xbf, 0x5f, 0xde, 0xd6, 0xd6, 0xca, 0x73 }, "cEUR ", 18 },
+    { { 0xe8, 0x53, 0x7a, 0x3d, 0x05, 0x6d, 0xa4, 0x46, 0x67, 0x7b, 0x9e, 0x9d, 0x6c, 0x5d, 0xb7, 0x04, 0xea, 0xab, 0x47, 0x87 }, "cREAL ", 18 },
+};
+
+// Index in TOKENS_LIST plus one of each slot, 0 when empty
+static const uint8_t TOKENS_SLOTS[1 << TOKENS_HASH_BITS] = { 3, 2, 1, 4 };
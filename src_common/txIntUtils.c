@@ -0,0 +1,86 @@
+/*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "txIntUtils.h"
+
+#include <string.h>
+
+void convertUint256BE(const uint8_t *data, uint32_t length, uint256_t *target) {
+    uint8_t tmp[32];
+    memset(tmp, 0, 32);
+    memcpy(tmp + 32 - length, data, length);
+    readu256BE(tmp, target);
+}
+
+// Skips the leading zero bytes of a big endian integer, returning its
+// significant length
+static uint32_t significantLength(const uint8_t **data, uint32_t length) {
+    while ((length != 0) && (**data == 0)) {
+        (*data)++;
+        length--;
+    }
+    return length;
+}
+
+static uint64_t convertUint64BE(const uint8_t *data, uint32_t length) {
+    uint64_t result = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        result = (result << 8) | data[i];
+    }
+    return result;
+}
+
+bool txIntToString(const uint8_t *data, uint32_t length, char *out, uint32_t outLength) {
+    length = significantLength(&data, length);
+    if (length <= 8) {
+        return tostring64(convertUint64BE(data, length), 10, out, outLength);
+    }
+    if (length <= 16) {
+        uint128_t number;
+        UPPER(number) = convertUint64BE(data, length - 8);
+        LOWER(number) = convertUint64BE(data + length - 8, 8);
+        return tostring128(&number, 10, out, outLength);
+    }
+    uint256_t number;
+    convertUint256BE(data, length, &number);
+    return tostring256(&number, 10, out, outLength);
+}
+
+bool txIntProductToString(const uint8_t *data1, uint32_t length1,
+                          const uint8_t *data2, uint32_t length2,
+                          char *out, uint32_t outLength) {
+    length1 = significantLength(&data1, length1);
+    length2 = significantLength(&data2, length2);
+    if ((length1 <= 8) && (length2 <= 8)) {
+        uint128_t product;
+        mul64(convertUint64BE(data1, length1), convertUint64BE(data2, length2), &product);
+        return tostring128(&product, 10, out, outLength);
+    }
+    uint256_t number1, number2, product;
+    convertUint256BE(data1, length1, &number1);
+    convertUint256BE(data2, length2, &number2);
+    mul256(&number1, &number2, &product);
+    return tostring256(&product, 10, out, outLength);
+}
+
+uint32_t txIntBits(const uint8_t *data, uint32_t length) {
+    length = significantLength(&data, length);
+    if (length == 0) {
+        return 0;
+    }
+    return 8 * length - __builtin_clz(data[0]) + 24;
+}
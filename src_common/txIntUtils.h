@@ -0,0 +1,39 @@
+/*******************************************************************************
+*   Ledger Ethereum App
+*   (c) 2016-2019 Ledger
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#ifndef _TXINTUTILS_H_
+#define _TXINTUTILS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "uint256.h"
+
+// Big endian transaction integer, up to 32 bytes, as a uint256
+void convertUint256BE(const uint8_t *data, uint32_t length, uint256_t *target);
+
+// Decimal rendering of big endian transaction integers, using native 64 bits
+// arithmetic when the values are small enough and 256 bits otherwise
+bool txIntToString(const uint8_t *data, uint32_t length, char *out, uint32_t outLength);
+bool txIntProductToString(const uint8_t *data1, uint32_t length1,
+                          const uint8_t *data2, uint32_t length2,
+                          char *out, uint32_t outLength);
+
+// Number of significant bits of a big endian transaction integer
+uint32_t txIntBits(const uint8_t *data, uint32_t length);
+
+#endif /* _TXINTUTILS_H_ */
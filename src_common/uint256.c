@@ -19,10 +19,20 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "uint256.h"
+#include "hexUtils.h"
 
-static const char HEXDIGITS[] = "0123456789abcdef";
+
+#ifdef UINT256_STATS
+// Number of 256 bits primitives executed, nested calls included. This is
+// used by the host benchmarks as a platform independent measure of work.
+uint32_t uint256_op_count;
+#define UINT256_COUNT_OP() uint256_op_count++
+#else
+#define UINT256_COUNT_OP()
+#endif
 
 static uint64_t readUint64BE(const uint8_t *buffer) {
     return (((uint64_t)buffer[0]) << 56) | (((uint64_t)buffer[1]) << 48) |
@@ -37,8 +47,46 @@ void readu128BE(const uint8_t *buffer, uint128_t *target) {
 }
 
 void readu256BE(const uint8_t *buffer, uint256_t *target) {
-    readu128BE(buffer, &UPPER_P(target));
-    readu128BE(buffer + 16, &LOWER_P(target));
+    UINT256_COUNT_OP();
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        target->elements[i] = readUint64BE(buffer + 8 * i);
+    }
+}
+
+static uint32_t bits64(uint64_t number) {
+    return (number == 0 ? 0 : 64 - __builtin_clzll(number));
+}
+
+static inline uint64_t mul32x32(uint32_t number1, uint32_t number2) {
+    return (uint64_t)number1 * number2;
+}
+
+// 64x64 -> 128 bits product, built from 32 bits halves so that it does not
+// rely on a native 128 bits type
+static void mul64x64(uint64_t number1, uint64_t number2, uint64_t *high,
+                     uint64_t *low) {
+    uint32_t n1Low = (uint32_t)number1;
+    uint32_t n1High = (uint32_t)(number1 >> 32);
+    uint32_t n2Low = (uint32_t)number2;
+    uint32_t n2High = (uint32_t)(number2 >> 32);
+    uint64_t lowLow = mul32x32(n1Low, n2Low);
+    uint64_t lowHigh = mul32x32(n1Low, n2High);
+    uint64_t highLow = mul32x32(n1High, n2Low);
+    uint64_t highHigh = mul32x32(n1High, n2High);
+    uint64_t middle =
+        (lowLow >> 32) + (lowHigh & 0xffffffff) + (highLow & 0xffffffff);
+    *low = (middle << 32) | (lowLow & 0xffffffff);
+    *high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+}
+
+// Low 64 bits of a 64x64 bits product, the cross products only need their
+// low 32 bits
+static uint64_t mul64x64Low(uint64_t number1, uint64_t number2) {
+    uint32_t n1Low = (uint32_t)number1;
+    uint32_t n2Low = (uint32_t)number2;
+    uint32_t cross = n1Low * (uint32_t)(number2 >> 32) +
+                     (uint32_t)(number1 >> 32) * n2Low;
+    return mul32x32(n1Low, n2Low) + ((uint64_t)cross << 32);
 }
 
 bool zero128(const uint128_t *number) {
@@ -46,7 +94,9 @@ bool zero128(const uint128_t *number) {
 }
 
 bool zero256(const uint256_t *number) {
-    return (zero128(&LOWER_P(number)) && zero128(&UPPER_P(number)));
+    UINT256_COUNT_OP();
+    return ((number->elements[0] | number->elements[1] |
+             number->elements[2] | number->elements[3]) == 0);
 }
 
 void copy128(uint128_t *target, const uint128_t *number) {
@@ -55,8 +105,8 @@ void copy128(uint128_t *target, const uint128_t *number) {
 }
 
 void copy256(uint256_t *target, const uint256_t *number) {
-    copy128(&UPPER_P(target), &UPPER_P(number));
-    copy128(&LOWER_P(target), &LOWER_P(number));
+    UINT256_COUNT_OP();
+    *target = *number;
 }
 
 void clear128(uint128_t *target) {
@@ -65,8 +115,8 @@ void clear128(uint128_t *target) {
 }
 
 void clear256(uint256_t *target) {
-    clear128(&UPPER_P(target));
-    clear128(&LOWER_P(target));
+    UINT256_COUNT_OP();
+    memset(target, 0, sizeof(uint256_t));
 }
 
 void shiftl128(const uint128_t *number, uint32_t value, uint128_t *target) {
@@ -87,27 +137,28 @@ void shiftl128(const uint128_t *number, uint32_t value, uint128_t *target) {
     }
 }
 
+// Shifts move whole limbs first, then the remaining bits across limbs
 void shiftl256(const uint256_t *number, uint32_t value, uint256_t *target) {
-    if (value == 128) {
-        copy128(&UPPER_P(target), &LOWER_P(number));
-        clear128(&LOWER_P(target));
-    } else if (value == 0) {
-        copy256(target, number);
-    } else if (value < 128) {
-        uint128_t tmp1;
-        uint128_t tmp2;
-        uint256_t result;
-        shiftl128(&UPPER_P(number), value, &tmp1);
-        shiftr128(&LOWER_P(number), (128 - value), &tmp2);
-        add128(&tmp1, &tmp2, &UPPER(result));
-        shiftl128(&LOWER_P(number), value, &LOWER(result));
-        copy256(target, &result);
-    } else if ((256 > value) && (value > 128)) {
-        shiftl128(&LOWER_P(number), (value - 128), &UPPER_P(target));
-        clear128(&LOWER_P(target));
-    } else {
+    UINT256_COUNT_OP();
+    uint256_t result;
+    uint32_t limbs = value / 64;
+    uint32_t bits = value % 64;
+    if (value >= 256) {
         clear256(target);
+        return;
     }
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        uint32_t source = i + limbs;
+        uint64_t limb = 0;
+        if (source < UINT256_LIMBS) {
+            limb = number->elements[source] << bits;
+            if ((bits != 0) && (source + 1 < UINT256_LIMBS)) {
+                limb |= number->elements[source + 1] >> (64 - bits);
+            }
+        }
+        result.elements[i] = limb;
+    }
+    copy256(target, &result);
 }
 
 void shiftr128(const uint128_t *number, uint32_t value, uint128_t *target) {
@@ -131,66 +182,43 @@ void shiftr128(const uint128_t *number, uint32_t value, uint128_t *target) {
 }
 
 void shiftr256(const uint256_t *number, uint32_t value, uint256_t *target) {
-    if (value == 128) {
-        copy128(&LOWER_P(target), &UPPER_P(number));
-        clear128(&UPPER_P(target));
-    } else if (value == 0) {
-        copy256(target, number);
-    } else if (value < 128) {
-        uint128_t tmp1;
-        uint128_t tmp2;
-        uint256_t result;
-        shiftr128(&UPPER_P(number), value, &UPPER(result));
-        shiftr128(&LOWER_P(number), value, &tmp1);
-        shiftl128(&UPPER_P(number), (128 - value), &tmp2);
-        add128(&tmp1, &tmp2, &LOWER(result));
-        copy256(target, &result);
-    } else if ((256 > value) && (value > 128)) {
-        shiftr128(&UPPER_P(number), (value - 128), &LOWER_P(target));
-        clear128(&UPPER_P(target));
-    } else {
+    UINT256_COUNT_OP();
+    uint256_t result;
+    uint32_t limbs = value / 64;
+    uint32_t bits = value % 64;
+    if (value >= 256) {
         clear256(target);
+        return;
     }
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        uint64_t limb = 0;
+        if (i >= limbs) {
+            uint32_t source = i - limbs;
+            limb = number->elements[source] >> bits;
+            if ((bits != 0) && (source > 0)) {
+                limb |= number->elements[source - 1] << (64 - bits);
+            }
+        }
+        result.elements[i] = limb;
+    }
+    copy256(target, &result);
 }
 
 uint32_t bits128(const uint128_t *number) {
-    uint32_t result = 0;
     if (UPPER_P(number)) {
-        result = 64;
-        uint64_t up = UPPER_P(number);
-        while (up) {
-            up >>= 1;
-            result++;
-        }
-    } else {
-        uint64_t low = LOWER_P(number);
-        while (low) {
-            low >>= 1;
-            result++;
-        }
+        return 64 + bits64(UPPER_P(number));
     }
-    return result;
+    return bits64(LOWER_P(number));
 }
 
 uint32_t bits256(const uint256_t *number) {
-    uint32_t result = 0;
-    if (!zero128(&UPPER_P(number))) {
-        result = 128;
-        uint128_t up;
-        copy128(&up, &UPPER_P(number));
-        while (!zero128(&up)) {
-            shiftr128(&up, 1, &up);
-            result++;
-        }
-    } else {
-        uint128_t low;
-        copy128(&low, &LOWER_P(number));
-        while (!zero128(&low)) {
-            shiftr128(&low, 1, &low);
-            result++;
+    UINT256_COUNT_OP();
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        if (number->elements[i]) {
+            return 64 * (UINT256_LIMBS - 1 - i) + bits64(number->elements[i]);
         }
     }
-    return result;
+    return 0;
 }
 
 bool equal128(const uint128_t *number1, const uint128_t *number2) {
@@ -199,8 +227,13 @@ bool equal128(const uint128_t *number1, const uint128_t *number2) {
 }
 
 bool equal256(const uint256_t *number1, const uint256_t *number2) {
-    return (equal128(&UPPER_P(number1), &UPPER_P(number2)) &&
-            equal128(&LOWER_P(number1), &LOWER_P(number2)));
+    UINT256_COUNT_OP();
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        if (number1->elements[i] != number2->elements[i]) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool gt128(const uint128_t *number1, const uint128_t *number2) {
@@ -211,10 +244,13 @@ bool gt128(const uint128_t *number1, const uint128_t *number2) {
 }
 
 bool gt256(const uint256_t *number1, const uint256_t *number2) {
-    if (equal128(&UPPER_P(number1), &UPPER_P(number2))) {
-        return gt128(&LOWER_P(number1), &LOWER_P(number2));
+    UINT256_COUNT_OP();
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        if (number1->elements[i] != number2->elements[i]) {
+            return (number1->elements[i] > number2->elements[i]);
+        }
     }
-    return gt128(&UPPER_P(number1), &UPPER_P(number2));
+    return false;
 }
 
 bool gte128(const uint128_t *number1, const uint128_t *number2) {
@@ -222,7 +258,13 @@ bool gte128(const uint128_t *number1, const uint128_t *number2) {
 }
 
 bool gte256(const uint256_t *number1, const uint256_t *number2) {
-    return gt256(number1, number2) || equal256(number1, number2);
+    UINT256_COUNT_OP();
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        if (number1->elements[i] != number2->elements[i]) {
+            return (number1->elements[i] > number2->elements[i]);
+        }
+    }
+    return true;
 }
 
 void add128(const uint128_t *number1, const uint128_t *number2, uint128_t *target) {
@@ -233,16 +275,17 @@ void add128(const uint128_t *number1, const uint128_t *number2, uint128_t *targe
 }
 
 void add256(const uint256_t *number1, const uint256_t *number2, uint256_t *target) {
-    uint128_t tmp;
-    add128(&UPPER_P(number1), &UPPER_P(number2), &UPPER_P(target));
-    add128(&LOWER_P(number1), &LOWER_P(number2), &tmp);
-    if (gt128(&LOWER_P(number1), &tmp)) {
-        uint128_t one;
-        UPPER(one) = 0;
-        LOWER(one) = 1;
-        add128(&UPPER_P(target), &one, &UPPER_P(target));
+    UINT256_COUNT_OP();
+    uint64_t carry = 0;
+    for (int i = UINT256_LIMBS - 1; i >= 0; i--) {
+        uint64_t limb = number1->elements[i];
+        uint64_t sum = limb + number2->elements[i];
+        uint64_t nextCarry = (sum < limb);
+        sum += carry;
+        nextCarry |= (sum < carry);
+        target->elements[i] = sum;
+        carry = nextCarry;
     }
-    add128(&LOWER_P(number1), &LOWER_P(number2), &LOWER_P(target));
 }
 
 void minus128(const uint128_t *number1, const uint128_t *number2, uint128_t *target) {
@@ -253,16 +296,17 @@ void minus128(const uint128_t *number1, const uint128_t *number2, uint128_t *tar
 }
 
 void minus256(const uint256_t *number1, const uint256_t *number2, uint256_t *target) {
-    uint128_t tmp;
-    minus128(&UPPER_P(number1), &UPPER_P(number2), &UPPER_P(target));
-    minus128(&LOWER_P(number1), &LOWER_P(number2), &tmp);
-    if (gt128(&tmp, &LOWER_P(number1))) {
-        uint128_t one;
-        UPPER(one) = 0;
-        LOWER(one) = 1;
-        minus128(&UPPER_P(target), &one, &UPPER_P(target));
+    UINT256_COUNT_OP();
+    uint64_t borrow = 0;
+    for (int i = UINT256_LIMBS - 1; i >= 0; i--) {
+        uint64_t limb = number1->elements[i];
+        uint64_t difference = limb - number2->elements[i];
+        uint64_t nextBorrow = (difference > limb);
+        nextBorrow |= (difference < borrow);
+        difference -= borrow;
+        target->elements[i] = difference;
+        borrow = nextBorrow;
     }
-    minus128(&LOWER_P(number1), &LOWER_P(number2), &LOWER_P(target));
 }
 
 void or128(const uint128_t *number1, const  uint128_t *number2, uint128_t *target) {
@@ -271,144 +315,49 @@ void or128(const uint128_t *number1, const  uint128_t *number2, uint128_t *targe
 }
 
 void or256(const  uint256_t *number1, const  uint256_t *number2, uint256_t *target) {
-    or128(&UPPER_P(number1), &UPPER_P(number2), &UPPER_P(target));
-    or128(&LOWER_P(number1), &LOWER_P(number2), &LOWER_P(target));
-}
-
-void mul128(const uint128_t *number1, const uint128_t *number2, uint128_t *target) {
-    uint64_t top[4] = {UPPER_P(number1) >> 32, UPPER_P(number1) & 0xffffffff,
-                       LOWER_P(number1) >> 32, LOWER_P(number1) & 0xffffffff};
-    uint64_t bottom[4] = {UPPER_P(number2) >> 32, UPPER_P(number2) & 0xffffffff,
-                          LOWER_P(number2) >> 32,
-                          LOWER_P(number2) & 0xffffffff};
-    uint64_t products[4][4];
-    uint128_t tmp, tmp2;
-
-    for (int y = 3; y > -1; y--) {
-        for (int x = 3; x > -1; x--) {
-            products[3 - x][y] = top[x] * bottom[y];
-        }
+    UINT256_COUNT_OP();
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        target->elements[i] = number1->elements[i] | number2->elements[i];
     }
+}
 
-    uint64_t fourth32 = products[0][3] & 0xffffffff;
-    uint64_t third32 = (products[0][2] & 0xffffffff) + (products[0][3] >> 32);
-    uint64_t second32 = (products[0][1] & 0xffffffff) + (products[0][2] >> 32);
-    uint64_t first32 = (products[0][0] & 0xffffffff) + (products[0][1] >> 32);
-
-    third32 += products[1][3] & 0xffffffff;
-    second32 += (products[1][2] & 0xffffffff) + (products[1][3] >> 32);
-    first32 += (products[1][1] & 0xffffffff) + (products[1][2] >> 32);
-
-    second32 += products[2][3] & 0xffffffff;
-    first32 += (products[2][2] & 0xffffffff) + (products[2][3] >> 32);
-
-    first32 += products[3][3] & 0xffffffff;
+void mul64(uint64_t number1, uint64_t number2, uint128_t *target) {
+    mul64x64(number1, number2, &UPPER_P(target), &LOWER_P(target));
+}
 
-    UPPER(tmp) = first32 << 32;
-    LOWER(tmp) = 0;
-    UPPER(tmp2) = third32 >> 32;
-    LOWER(tmp2) = third32 << 32;
-    add128(&tmp, &tmp2, target);
-    UPPER(tmp) = second32;
-    LOWER(tmp) = 0;
-    add128(&tmp, target, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = fourth32;
-    add128(&tmp, &tmp2, target);
+void mul128(const uint128_t *number1, const uint128_t *number2, uint128_t *target) {
+    uint64_t high, low;
+    mul64x64(LOWER_P(number1), LOWER_P(number2), &high, &low);
+    high += mul64x64Low(UPPER_P(number1), LOWER_P(number2));
+    high += mul64x64Low(LOWER_P(number1), UPPER_P(number2));
+    UPPER_P(target) = high;
+    LOWER_P(target) = low;
 }
 
+// Schoolbook multiplication on 64 bits limbs, truncated to 256 bits
 void mul256(const uint256_t *number1, const uint256_t *number2, uint256_t *target) {
-    uint128_t top[4];
-    uint128_t bottom[4];
-    uint128_t products[4][4];
-    uint128_t tmp, tmp2, fourth64, third64, second64, first64;
-    uint256_t target1, target2;
-    UPPER(top[0]) = 0;
-    LOWER(top[0]) = UPPER(UPPER_P(number1));
-    UPPER(top[1]) = 0;
-    LOWER(top[1]) = LOWER(UPPER_P(number1));
-    UPPER(top[2]) = 0;
-    LOWER(top[2]) = UPPER(LOWER_P(number1));
-    UPPER(top[3]) = 0;
-    LOWER(top[3]) = LOWER(LOWER_P(number1));
-    UPPER(bottom[0]) = 0;
-    LOWER(bottom[0]) = UPPER(UPPER_P(number2));
-    UPPER(bottom[1]) = 0;
-    LOWER(bottom[1]) = LOWER(UPPER_P(number2));
-    UPPER(bottom[2]) = 0;
-    LOWER(bottom[2]) = UPPER(LOWER_P(number2));
-    UPPER(bottom[3]) = 0;
-    LOWER(bottom[3]) = LOWER(LOWER_P(number2));
-
-    for (int y = 3; y > -1; y--) {
-        for (int x = 3; x > -1; x--) {
-            mul128(&top[x], &bottom[y], &products[3 - x][y]);
+    UINT256_COUNT_OP();
+    // Least significant limb first
+    uint64_t result[UINT256_LIMBS] = {0};
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        uint64_t limb1 = number1->elements[UINT256_LIMBS - 1 - i];
+        uint64_t carry = 0;
+        if (limb1 == 0) {
+            continue;
+        }
+        for (uint32_t j = 0; i + j < UINT256_LIMBS; j++) {
+            uint64_t high, low;
+            mul64x64(limb1, number2->elements[UINT256_LIMBS - 1 - j], &high, &low);
+            low += carry;
+            high += (low < carry);
+            result[i + j] += low;
+            high += (result[i + j] < low);
+            carry = high;
         }
     }
-
-    UPPER(fourth64) = 0;
-    LOWER(fourth64) = LOWER(products[0][3]);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[0][2]);
-    UPPER(tmp2) = 0;
-    LOWER(tmp2) = UPPER(products[0][3]);
-    add128(&tmp, &tmp2, &third64);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[0][1]);
-    UPPER(tmp2) = 0;
-    LOWER(tmp2) = UPPER(products[0][2]);
-    add128(&tmp, &tmp2, &second64);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[0][0]);
-    UPPER(tmp2) = 0;
-    LOWER(tmp2) = UPPER(products[0][1]);
-    add128(&tmp, &tmp2, &first64);
-
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[1][3]);
-    add128(&tmp, &third64, &tmp2);
-    copy128(&third64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[1][2]);
-    add128(&tmp, &second64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = UPPER(products[1][3]);
-    add128(&tmp, &tmp2, &second64);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[1][1]);
-    add128(&tmp, &first64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = UPPER(products[1][2]);
-    add128(&tmp, &tmp2, &first64);
-
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[2][3]);
-    add128(&tmp, &second64, &tmp2);
-    copy128(&second64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[2][2]);
-    add128(&tmp, &first64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = UPPER(products[2][3]);
-    add128(&tmp, &tmp2, &first64);
-
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[3][3]);
-    add128(&tmp, &first64, &tmp2);
-    copy128(&first64, &tmp2);
-
-    clear256(&target1);
-    shiftl128(&first64, 64, &UPPER(target1));
-    clear256(&target2);
-    LOWER(UPPER(target2)) = UPPER(third64);
-    shiftl128(&third64, 64, &LOWER(target2));
-    add256(&target1, &target2, target);
-    clear256(&target1);
-    copy128(&UPPER(target1), &second64);
-    add256(&target1, target, &target2);
-    clear256(&target1);
-    copy128(&LOWER(target1), &fourth64);
-    add256(&target1, &target2, target);
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+        target->elements[i] = result[UINT256_LIMBS - 1 - i];
+    }
 }
 
 void divmod128(uint128_t *l, uint128_t *r, uint128_t *div,
@@ -443,13 +392,46 @@ void divmod128(uint128_t *l, uint128_t *r, uint128_t *div,
     }
 }
 
+// Divides limbs (most significant first) in place by a small divisor, one 32
+// bits word at a time so that only 64/32 bits divisions are needed, and
+// returns the remainder
+static uint32_t divmodLimbsBy32(uint64_t *limbs, uint32_t count,
+                                uint32_t divisor) {
+    uint64_t remainder = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t high = (remainder << 32) | (limbs[i] >> 32);
+        uint64_t low;
+        remainder = high % divisor;
+        low = (remainder << 32) | (limbs[i] & 0xffffffff);
+        remainder = low % divisor;
+        limbs[i] = ((high / divisor) << 32) | (low / divisor);
+    }
+    return (uint32_t)remainder;
+}
+
 void divmod256(uint256_t *l, uint256_t *r, uint256_t *div,
                uint256_t *mod) {
+    UINT256_COUNT_OP();
+#ifdef UINT256_FAST_DIVISION
+    // Short division when the divisor fits in 32 bits, which covers every
+    // decimal conversion
+    if (((r->elements[0] | r->elements[1] | r->elements[2]) == 0) &&
+        ((r->elements[3] >> 32) == 0) && (r->elements[3] != 0)) {
+        uint256_t quotient;
+        uint32_t remainder;
+        copy256(&quotient, l);
+        remainder = divmodLimbsBy32(quotient.elements, UINT256_LIMBS,
+                                    (uint32_t)r->elements[3]);
+        copy256(div, &quotient);
+        clear256(mod);
+        mod->elements[UINT256_LIMBS - 1] = remainder;
+        return;
+    }
+#endif
     uint256_t copyd, adder, resDiv, resMod;
     uint256_t one;
     clear256(&one);
-    UPPER(LOWER(one)) = 0;
-    LOWER(LOWER(one)) = 1;
+    one.elements[UINT256_LIMBS - 1] = 1;
     uint32_t diffBits = bits256(l) - bits256(r);
     clear256(&resDiv);
     copy256(&resMod, l);
@@ -486,25 +468,40 @@ static void reverseString(char *str, uint32_t length) {
     }
 }
 
+bool tostring64(uint64_t number, uint32_t base, char *out,
+                uint32_t outLength) {
+    uint32_t offset = 0;
+    if ((base < 2) || (base > 16)) {
+        return false;
+    }
+    do {
+        if (offset >= (outLength - 1)) {
+            return false;
+        }
+        out[offset++] = hexDigit(number % base);
+        number /= base;
+    } while (number != 0);
+    out[offset] = '\0';
+    reverseString(out, offset);
+    return true;
+}
+
 bool tostring128(const uint128_t *number, uint32_t base, char *out,
                  uint32_t outLength) {
     uint128_t rDiv;
-    uint128_t rMod;
-    uint128_t outputBase;
-    copy128(&rDiv, number);
-    clear128(&rMod);
-    clear128(&outputBase);
-    LOWER(outputBase) = base;
     uint32_t offset = 0;
     if ((base < 2) || (base > 16)) {
         return false;
     }
+    if (UPPER_P(number) == 0) {
+        return tostring64(LOWER_P(number), base, out, outLength);
+    }
+    copy128(&rDiv, number);
     do {
-        if (offset > (outLength - 1)) {
+        if (offset >= (outLength - 1)) {
             return false;
         }
-        divmod128(&rDiv, &outputBase, &rDiv, &rMod);
-        out[offset++] = HEXDIGITS[(uint8_t)LOWER(rMod)];
+        out[offset++] = hexDigit(divmodLimbsBy32(rDiv.elements, 2, base));
     } while (!zero128(&rDiv));
     out[offset] = '\0';
     reverseString(out, offset);
@@ -513,25 +510,50 @@ bool tostring128(const uint128_t *number, uint32_t base, char *out,
 
 bool tostring256(const uint256_t *number, uint32_t base, char *out,
                  uint32_t outLength) {
+    UINT256_COUNT_OP();
     uint256_t rDiv;
-    uint256_t rMod;
-    uint256_t outputBase;
-    copy256(&rDiv, number);
-    clear256(&rMod);
-    clear256(&outputBase);
-    UPPER(LOWER(outputBase)) = 0;
-    LOWER(LOWER(outputBase)) = base;
     uint32_t offset = 0;
+    copy256(&rDiv, number);
     if ((base < 2) || (base > 16)) {
         return false;
     }
+#ifdef UINT256_FAST_DIVISION
+    // Extract as many digits as fit in a 32 bits word per division
+    uint32_t chunk = base;
+    uint32_t chunkDigits = 1;
+    while (chunk <= 0xffffffff / base) {
+        chunk *= base;
+        chunkDigits++;
+    }
+    do {
+        uint32_t remainder = divmodLimbsBy32(rDiv.elements, UINT256_LIMBS, chunk);
+        bool last = zero256(&rDiv);
+        for (uint32_t i = 0; i < chunkDigits; i++) {
+            // No leading zeros on the most significant chunk
+            if (last && (i != 0) && (remainder == 0)) {
+                break;
+            }
+            if (offset >= (outLength - 1)) {
+                return false;
+            }
+            out[offset++] = hexDigit(remainder % base);
+            remainder /= base;
+        }
+    } while (!zero256(&rDiv));
+#else
+    uint256_t rMod;
+    uint256_t outputBase;
+    clear256(&rMod);
+    clear256(&outputBase);
+    outputBase.elements[UINT256_LIMBS - 1] = base;
     do {
-        if (offset > (outLength - 1)) {
+        if (offset >= (outLength - 1)) {
             return false;
         }
         divmod256(&rDiv, &outputBase, &rDiv, &rMod);
-        out[offset++] = HEXDIGITS[(uint8_t)LOWER(LOWER(rMod))];
+        out[offset++] = hexDigit((uint8_t)rMod.elements[UINT256_LIMBS - 1]);
     } while (!zero256(&rDiv));
+#endif
     out[offset] = '\0';
     reverseString(out, offset);
     return true;
@@ -25,7 +25,16 @@
 
 typedef struct uint128_t { uint64_t elements[2]; } uint128_t;
 
-typedef struct uint256_t { uint128_t elements[2]; } uint256_t;
+// Flat limbs, most significant first, the same memory layout as the former
+// pair of uint128_t. Initializers list the four limbs in an inner brace,
+// { { a, b, c, d } }.
+typedef struct uint256_t { uint64_t elements[4]; } uint256_t;
+
+#define UINT256_LIMBS 4
+
+#ifdef UINT256_STATS
+extern uint32_t uint256_op_count;
+#endif
 
 #define UPPER_P(x) x->elements[0]
 #define LOWER_P(x) x->elements[1]
@@ -58,10 +67,13 @@ void minus128(const uint128_t *number1, const uint128_t *number2, uint128_t *tar
 void minus256(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
 void or128(const uint128_t *number1, const uint128_t *number2, uint128_t *target);
 void or256(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
+void mul64(uint64_t number1, uint64_t number2, uint128_t *target);
 void mul128(const uint128_t *number1, const uint128_t *number2, uint128_t *target);
 void mul256(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
 void divmod128(uint128_t *l, uint128_t *r, uint128_t *div, uint128_t *mod);
 void divmod256(uint256_t *l, uint256_t *r, uint256_t *div, uint256_t *mod);
+bool tostring64(uint64_t number, uint32_t base, char *out,
+                uint32_t outLength);
 bool tostring128(const uint128_t *number, uint32_t base, char *out,
                  uint32_t outLength);
 bool tostring256(const uint256_t *number, uint32_t base, char *out,
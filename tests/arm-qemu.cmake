@@ -0,0 +1,24 @@
+# Cross build of the uint256 oracle for the device cores, run under qemu-arm
+# user mode:
+#
+#   cmake -S tests -B build-arm -DCMAKE_TOOLCHAIN_FILE=arm-qemu.cmake
+#   cmake --build build-arm --target oracle_uint256
+#   ctest --test-dir build-arm -R oracle_uint256
+#
+# ARM_CPU selects the core. Nano S: cortex-m0 (ARMv6-M), the default; Nano X:
+# cortex-m3 (ARMv7-M). Only the oracle is needed, the cmocka tests require a
+# cross built cmocka.
+
+set(CMAKE_SYSTEM_NAME Linux)
+set(CMAKE_SYSTEM_PROCESSOR arm)
+
+set(ARM_CPU "cortex-m0" CACHE STRING "Core the uint256 code is built for")
+
+set(CMAKE_C_COMPILER arm-linux-gnueabi-gcc)
+set(CMAKE_C_FLAGS_INIT "-mthumb -mcpu=${ARM_CPU}")
+# Static so that qemu-arm does not need the target sysroot
+set(CMAKE_EXE_LINKER_FLAGS_INIT "-static")
+set(CMAKE_CROSSCOMPILING_EMULATOR qemu-arm)
+
+set(UINT256_KERNELS "UINT256_FAST_DIVISION" CACHE STRING
+    "uint256 kernel options for the benchmark and the oracle")
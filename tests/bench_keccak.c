@@ -0,0 +1,68 @@
+// Keccak-256 batch throughput of each supported backend.
+//
+// Usage: bench_keccak [messages]
+//
+// Hashes a queue of transaction sized messages (100 to 300 bytes, 100000 by
+// default) with every backend the CPU supports and prints one CSV line each.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "keccak.h"
+
+#define DEFAULT_MESSAGES 100000
+#define MIN_LENGTH 100
+#define MAX_LENGTH 300
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+  size_t count = DEFAULT_MESSAGES;
+  uint32_t seed = 1;
+  uint64_t bytes = 0;
+
+  if (argc > 1) {
+    count = strtoul(argv[1], NULL, 10);
+  }
+  uint8_t *data = malloc(count * MAX_LENGTH);
+  const uint8_t **inputs = malloc(count * sizeof(uint8_t *));
+  size_t *lengths = malloc(count * sizeof(size_t));
+  uint8_t (*outputs)[32] = malloc(count * 32);
+  if ((data == NULL) || (inputs == NULL) || (lengths == NULL) || (outputs == NULL)) {
+    return 1;
+  }
+  for (size_t i = 0; i < count; i++) {
+    seed = seed * 1103515245 + 12345;
+    lengths[i] = MIN_LENGTH + (seed >> 8) % (MAX_LENGTH - MIN_LENGTH + 1);
+    inputs[i] = data + i * MAX_LENGTH;
+    for (size_t j = 0; j < lengths[i]; j++) {
+      seed = seed * 1103515245 + 12345;
+      data[i * MAX_LENGTH + j] = (uint8_t)(seed >> 16);
+    }
+    bytes += lengths[i];
+  }
+
+  printf("backend,messages,ms,mb_per_s\n");
+  for (int backend = 0; backend < KECCAK_BACKEND_COUNT; backend++) {
+    if (!keccakSetBackend(backend)) {
+      continue;
+    }
+    uint64_t start = nowNs();
+    keccak256Batch(inputs, lengths, count, outputs);
+    double ns = (double)(nowNs() - start);
+    printf("%s,%zu,%.2f,%.1f\n", keccakBackendName(backend), count, ns / 1e6, bytes * 1e3 / ns);
+  }
+  free(data);
+  free(inputs);
+  free(lengths);
+  free(outputs);
+  return 0;
+}
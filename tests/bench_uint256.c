@@ -0,0 +1,238 @@
+// Micro-benchmarks for the uint256 kernels.
+//
+// Usage: bench_uint256 [baseline.csv]
+//
+// Every kernel runs over fixed, seeded input distributions. The output is CSV
+// with one line per kernel and distribution: time per call and the number of
+// 256 bits primitives executed per call (a host independent measure of the
+// work done, see UINT256_STATS). When a baseline file produced by an earlier
+// run is given, its timings are reported next to the current ones.
+// bench_uint256_baseline.csv holds the reference numbers.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "uint256.h"
+
+#define INPUTS 256
+#define MIN_DURATION_NS 50000000ULL
+#define MAX_BASELINE 64
+
+typedef enum {
+  DIST_SMALL,
+  DIST_WEI,
+  DIST_NEAR_MAX,
+  DIST_COUNT
+} distribution_e;
+
+static const char *const DISTRIBUTION_NAMES[DIST_COUNT] = {"small", "wei", "near_max"};
+
+typedef struct {
+  const char *name;
+  // Runs the kernel once on the given input pair and folds the result in sink
+  void (*run)(const uint256_t *a, const uint256_t *b, uint32_t shift, uint64_t *sink);
+} kernel_t;
+
+typedef struct {
+  char kernel[32];
+  char distribution[16];
+  double nsPerOp;
+} baseline_t;
+
+static uint256_t inputsA[DIST_COUNT][INPUTS];
+static uint256_t inputsB[DIST_COUNT][INPUTS];
+static uint32_t shifts[INPUTS];
+
+static uint64_t rngState = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rng(void) {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 7;
+  rngState ^= rngState << 17;
+  return rngState;
+}
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Builds a value with the given number of significant bytes
+static void randomBytes(uint256_t *target, uint32_t bytes) {
+  uint8_t buffer[32];
+  memset(buffer, 0, sizeof(buffer));
+  for (uint32_t i = 32 - bytes; i < 32; i++) {
+    buffer[i] = (uint8_t)rng();
+  }
+  if (bytes != 0 && buffer[32 - bytes] == 0) {
+    buffer[32 - bytes] = 1;
+  }
+  readu256BE(buffer, target);
+}
+
+static void generateInputs(void) {
+  for (uint32_t i = 0; i < INPUTS; i++) {
+    // Nonces, gas limits and gas prices
+    randomBytes(&inputsA[DIST_SMALL][i], 1 + rng() % 8);
+    randomBytes(&inputsB[DIST_SMALL][i], 1 + rng() % 4);
+    // Amounts between 0.001 and 10000 units with 18 decimals, gas prices
+    randomBytes(&inputsA[DIST_WEI][i], 7 + rng() % 3);
+    randomBytes(&inputsB[DIST_WEI][i], 4 + rng() % 2);
+    // Top limb set on both sides
+    randomBytes(&inputsA[DIST_NEAR_MAX][i], 32);
+    inputsA[DIST_NEAR_MAX][i].elements[0] |= 0xff00000000000000ULL;
+    randomBytes(&inputsB[DIST_NEAR_MAX][i], 25 + rng() % 8);
+    shifts[i] = rng() % 256;
+  }
+}
+
+static void runMul(const uint256_t *a, const uint256_t *b, uint32_t shift, uint64_t *sink) {
+  uint256_t r;
+  (void) shift;
+  mul256(a, b, &r);
+  *sink += r.elements[3];
+}
+
+static void runDivmod(const uint256_t *a, const uint256_t *b, uint32_t shift, uint64_t *sink) {
+  uint256_t l, r, div, mod;
+  (void) shift;
+  copy256(&l, a);
+  copy256(&r, b);
+  divmod256(&l, &r, &div, &mod);
+  *sink += div.elements[3] ^ mod.elements[3];
+}
+
+static void runTostring(const uint256_t *a, const uint256_t *b, uint32_t shift, uint64_t *sink) {
+  char out[100];
+  (void) b;
+  (void) shift;
+  tostring256(a, 10, out, sizeof(out));
+  *sink += (uint8_t)out[0];
+}
+
+static void runShiftl(const uint256_t *a, const uint256_t *b, uint32_t shift, uint64_t *sink) {
+  uint256_t r;
+  (void) b;
+  shiftl256(a, shift, &r);
+  *sink += r.elements[0];
+}
+
+static void runShiftr(const uint256_t *a, const uint256_t *b, uint32_t shift, uint64_t *sink) {
+  uint256_t r;
+  (void) b;
+  shiftr256(a, shift, &r);
+  *sink += r.elements[3];
+}
+
+static void runCompare(const uint256_t *a, const uint256_t *b, uint32_t shift, uint64_t *sink) {
+  (void) shift;
+  *sink += gt256(a, b) + gte256(b, a) + equal256(a, b);
+}
+
+static void runBits(const uint256_t *a, const uint256_t *b, uint32_t shift, uint64_t *sink) {
+  (void) b;
+  (void) shift;
+  *sink += bits256(a);
+}
+
+static const kernel_t KERNELS[] = {
+  {"mul256", runMul},
+  {"divmod256", runDivmod},
+  {"tostring256", runTostring},
+  {"shiftl256", runShiftl},
+  {"shiftr256", runShiftr},
+  {"compare256", runCompare},
+  {"bits256", runBits},
+};
+
+static uint32_t loadBaseline(const char *path, baseline_t *baseline) {
+  char line[256];
+  uint32_t count = 0;
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    fprintf(stderr, "Cannot open baseline %s\n", path);
+    exit(1);
+  }
+  while (fgets(line, sizeof(line), f) != NULL && count < MAX_BASELINE) {
+    baseline_t *entry = &baseline[count];
+    if (sscanf(line, "%31[^,],%15[^,],%*[^,],%lf", entry->kernel, entry->distribution, &entry->nsPerOp) == 3) {
+      count++;
+    }
+  }
+  fclose(f);
+  return count;
+}
+
+static const baseline_t *findBaseline(const baseline_t *baseline, uint32_t count, const char *kernel, const char *distribution) {
+  for (uint32_t i = 0; i < count; i++) {
+    if (strcmp(baseline[i].kernel, kernel) == 0 && strcmp(baseline[i].distribution, distribution) == 0) {
+      return &baseline[i];
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  static baseline_t baseline[MAX_BASELINE];
+  uint32_t baselineCount = 0;
+  uint64_t sink = 0;
+
+  if (argc > 1) {
+    baselineCount = loadBaseline(argv[1], baseline);
+  }
+  generateInputs();
+
+  printf("kernel,distribution,iterations,ns_per_op,uint256_ops_per_call");
+  if (baselineCount != 0) {
+    printf(",baseline_ns_per_op,speedup");
+  }
+  printf("\n");
+
+  for (uint32_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); k++) {
+    for (uint32_t d = 0; d < DIST_COUNT; d++) {
+      const kernel_t *kernel = &KERNELS[k];
+      uint64_t iterations = 0;
+      uint64_t start, elapsed;
+      double opsPerCall;
+
+      // One untimed pass to count the primitives and warm the caches
+      uint256_op_count = 0;
+      for (uint32_t i = 0; i < INPUTS; i++) {
+        kernel->run(&inputsA[d][i], &inputsB[d][i], shifts[i], &sink);
+      }
+      opsPerCall = (double)uint256_op_count / INPUTS;
+
+      start = nowNs();
+      do {
+        for (uint32_t i = 0; i < INPUTS; i++) {
+          kernel->run(&inputsA[d][i], &inputsB[d][i], shifts[i], &sink);
+        }
+        iterations += INPUTS;
+        elapsed = nowNs() - start;
+      } while (elapsed < MIN_DURATION_NS);
+
+      double nsPerOp = (double)elapsed / iterations;
+      printf("%s,%s,%llu,%.2f,%.2f", kernel->name, DISTRIBUTION_NAMES[d],
+             (unsigned long long)iterations, nsPerOp, opsPerCall);
+      if (baselineCount != 0) {
+        const baseline_t *reference = findBaseline(baseline, baselineCount, kernel->name, DISTRIBUTION_NAMES[d]);
+        if (reference != NULL) {
+          printf(",%.2f,%.2f", reference->nsPerOp, reference->nsPerOp / nsPerOp);
+        } else {
+          printf(",,");
+        }
+      }
+      printf("\n");
+    }
+  }
+
+  // Keeps the results alive
+  fprintf(stderr, "checksum %llx\n", (unsigned long long)sink);
+  return 0;
+}
@@ -0,0 +1,30 @@
+// Host replacement for the subset of the BOLOS cx.h hashing API used by
+// src_common, backed by the host Keccak in keccak.c
+
+#ifndef _HOST_CX_H_
+#define _HOST_CX_H_
+
+#include <stdint.h>
+
+#include "keccak.h"
+
+#define CX_LAST (1 << 0)
+
+typedef struct cx_hash_s {
+  keccak256_t keccak;
+} cx_hash_t;
+
+typedef cx_hash_t cx_sha3_t;
+
+typedef struct cx_ecfp_public_key_s {
+  unsigned int curve;
+  unsigned int W_len;
+  unsigned char W[65];
+} cx_ecfp_public_key_t;
+
+// Only 256 bits Keccak is supported
+int cx_keccak_init(cx_sha3_t *hash, unsigned int size);
+int cx_hash(cx_hash_t *hash, int mode, const unsigned char *in, unsigned int len,
+            unsigned char *out, unsigned int out_len);
+
+#endif // _HOST_CX_H_
@@ -0,0 +1,318 @@
+// Host Keccak-256, see keccak.h
+//
+// The batch backends keep their states lane interleaved: word i of lane l is
+// state[i * width + l]. Each lane absorbs its own message, the permutation
+// runs on all lanes at once, and a lane whose message is done is refilled
+// with the next one.
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_BACKENDS
+#endif
+
+#include "keccak.h"
+
+#define MAX_WIDTH 8
+
+static const uint64_t ROUND_CONSTANTS[24] = {
+  0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+  0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+  0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+  0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+  0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+  0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+  0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+  0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+// Rho rotation of each word, and the word pi moves it to
+static const unsigned ROTATIONS[25] = {
+  0, 1, 62, 28, 27, 36, 44, 6, 55, 20, 3, 10, 43,
+  25, 39, 41, 45, 15, 21, 8, 18, 2, 61, 56, 14
+};
+static const unsigned PI[25] = {
+  0, 10, 20, 5, 15, 16, 1, 11, 21, 6, 7, 17, 2,
+  12, 22, 23, 8, 18, 3, 13, 14, 24, 9, 19, 4
+};
+
+static uint64_t rol64(uint64_t value, unsigned shift) {
+  return (shift == 0 ? value : (value << shift) | (value >> (64 - shift)));
+}
+
+static void keccakF1600(uint64_t *state) {
+  uint64_t b[25], c[5], d[5];
+  for (int round = 0; round < 24; round++) {
+    for (int x = 0; x < 5; x++) {
+      c[x] = state[x] ^ state[x + 5] ^ state[x + 10] ^ state[x + 15] ^ state[x + 20];
+    }
+    for (int x = 0; x < 5; x++) {
+      d[x] = c[(x + 4) % 5] ^ rol64(c[(x + 1) % 5], 1);
+    }
+    for (int i = 0; i < 25; i++) {
+      b[PI[i]] = rol64(state[i] ^ d[i % 5], ROTATIONS[i]);
+    }
+    for (int y = 0; y < 25; y += 5) {
+      for (int x = 0; x < 5; x++) {
+        state[y + x] = b[y + x] ^ (~b[y + (x + 1) % 5] & b[y + (x + 2) % 5]);
+      }
+    }
+    state[0] ^= ROUND_CONSTANTS[round];
+  }
+}
+
+#ifdef HAVE_X86_BACKENDS
+
+__attribute__((target("avx2")))
+static __m256i rol64x4(__m256i value, unsigned shift) {
+  if (shift == 0) {
+    return value;
+  }
+  return _mm256_or_si256(_mm256_slli_epi64(value, shift), _mm256_srli_epi64(value, 64 - shift));
+}
+
+__attribute__((target("avx2")))
+static void keccakF1600x4(uint64_t *words) {
+  __m256i state[25], b[25], c[5], d[5];
+  for (int i = 0; i < 25; i++) {
+    state[i] = _mm256_loadu_si256((const __m256i *)(words + 4 * i));
+  }
+  for (int round = 0; round < 24; round++) {
+    for (int x = 0; x < 5; x++) {
+      c[x] = _mm256_xor_si256(_mm256_xor_si256(state[x], state[x + 5]),
+                              _mm256_xor_si256(_mm256_xor_si256(state[x + 10], state[x + 15]), state[x + 20]));
+    }
+    for (int x = 0; x < 5; x++) {
+      d[x] = _mm256_xor_si256(c[(x + 4) % 5], rol64x4(c[(x + 1) % 5], 1));
+    }
+    for (int i = 0; i < 25; i++) {
+      b[PI[i]] = rol64x4(_mm256_xor_si256(state[i], d[i % 5]), ROTATIONS[i]);
+    }
+    for (int y = 0; y < 25; y += 5) {
+      for (int x = 0; x < 5; x++) {
+        state[y + x] = _mm256_xor_si256(b[y + x], _mm256_andnot_si256(b[y + (x + 1) % 5], b[y + (x + 2) % 5]));
+      }
+    }
+    state[0] = _mm256_xor_si256(state[0], _mm256_set1_epi64x((long long)ROUND_CONSTANTS[round]));
+  }
+  for (int i = 0; i < 25; i++) {
+    _mm256_storeu_si256((__m256i *)(words + 4 * i), state[i]);
+  }
+}
+
+__attribute__((target("avx512f")))
+static void keccakF1600x8(uint64_t *words) {
+  __m512i state[25], b[25], c[5], d[5];
+  for (int i = 0; i < 25; i++) {
+    state[i] = _mm512_loadu_si512((const void *)(words + 8 * i));
+  }
+  for (int round = 0; round < 24; round++) {
+    for (int x = 0; x < 5; x++) {
+      // Three way XOR
+      c[x] = _mm512_ternarylogic_epi64(state[x], state[x + 5], state[x + 10], 0x96);
+      c[x] = _mm512_ternarylogic_epi64(c[x], state[x + 15], state[x + 20], 0x96);
+    }
+    for (int x = 0; x < 5; x++) {
+      d[x] = _mm512_xor_si512(c[(x + 4) % 5], _mm512_rol_epi64(c[(x + 1) % 5], 1));
+    }
+    for (int i = 0; i < 25; i++) {
+      __m512i value = _mm512_xor_si512(state[i], d[i % 5]);
+      b[PI[i]] = _mm512_rolv_epi64(value, _mm512_set1_epi64(ROTATIONS[i]));
+    }
+    for (int y = 0; y < 25; y += 5) {
+      for (int x = 0; x < 5; x++) {
+        // a ^ (~b & c)
+        state[y + x] = _mm512_ternarylogic_epi64(b[y + x], b[y + (x + 1) % 5], b[y + (x + 2) % 5], 0xd2);
+      }
+    }
+    state[0] = _mm512_xor_si512(state[0], _mm512_set1_epi64((long long)ROUND_CONSTANTS[round]));
+  }
+  for (int i = 0; i < 25; i++) {
+    _mm512_storeu_si512((void *)(words + 8 * i), state[i]);
+  }
+}
+
+#endif // HAVE_X86_BACKENDS
+
+typedef struct {
+  const char *name;
+  unsigned width;
+  void (*permute)(uint64_t *words);
+} backend_t;
+
+static const backend_t BACKENDS[KECCAK_BACKEND_COUNT] = {
+  {"scalar", 1, keccakF1600},
+#ifdef HAVE_X86_BACKENDS
+  {"avx2", 4, keccakF1600x4},
+  {"avx512", 8, keccakF1600x8},
+#else
+  {"avx2", 4, NULL},
+  {"avx512", 8, NULL},
+#endif
+};
+
+static int selectedBackend = -1;
+
+bool keccakBackendSupported(keccakBackend_e backend) {
+  switch (backend) {
+    case KECCAK_BACKEND_SCALAR:
+      return true;
+#ifdef HAVE_X86_BACKENDS
+    case KECCAK_BACKEND_AVX2:
+      return __builtin_cpu_supports("avx2");
+    case KECCAK_BACKEND_AVX512:
+      return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+  }
+}
+
+bool keccakSetBackend(keccakBackend_e backend) {
+  if ((backend >= KECCAK_BACKEND_COUNT) || !keccakBackendSupported(backend)) {
+    return false;
+  }
+  selectedBackend = backend;
+  return true;
+}
+
+keccakBackend_e keccakGetBackend(void) {
+  if (selectedBackend < 0) {
+    selectedBackend = KECCAK_BACKEND_SCALAR;
+    for (int backend = KECCAK_BACKEND_COUNT - 1; backend > KECCAK_BACKEND_SCALAR; backend--) {
+      if (keccakBackendSupported(backend)) {
+        selectedBackend = backend;
+        break;
+      }
+    }
+  }
+  return selectedBackend;
+}
+
+const char *keccakBackendName(keccakBackend_e backend) {
+  return (backend < KECCAK_BACKEND_COUNT ? BACKENDS[backend].name : "unknown");
+}
+
+static uint64_t readLE64(const uint8_t *data) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; i--) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+static void absorbBlock(uint64_t *words, unsigned width, unsigned lane, const uint8_t *block) {
+  for (unsigned i = 0; i < KECCAK256_RATE / 8; i++) {
+    words[i * width + lane] ^= readLE64(block + 8 * i);
+  }
+}
+
+static void squeeze(const uint64_t *words, unsigned width, unsigned lane, uint8_t *out) {
+  for (unsigned i = 0; i < 32; i++) {
+    out[i] = (uint8_t)(words[(i / 8) * width + lane] >> (8 * (i % 8)));
+  }
+}
+
+// Keccak padding of the last, partial, block of a message
+static void padBlock(const uint8_t *data, size_t length, uint8_t *block) {
+  memset(block, 0, KECCAK256_RATE);
+  memcpy(block, data, length);
+  block[length] ^= 0x01;
+  block[KECCAK256_RATE - 1] ^= 0x80;
+}
+
+void keccak256Init(keccak256_t *context) {
+  memset(context, 0, sizeof(keccak256_t));
+}
+
+void keccak256Update(keccak256_t *context, const uint8_t *data, size_t length) {
+  while (length != 0) {
+    size_t chunk = KECCAK256_RATE - context->blockLength;
+    if (chunk > length) {
+      chunk = length;
+    }
+    memcpy(context->block + context->blockLength, data, chunk);
+    context->blockLength += chunk;
+    data += chunk;
+    length -= chunk;
+    if (context->blockLength == KECCAK256_RATE) {
+      absorbBlock(context->state, 1, 0, context->block);
+      keccakF1600(context->state);
+      context->blockLength = 0;
+    }
+  }
+}
+
+void keccak256Final(keccak256_t *context, uint8_t *out) {
+  uint8_t block[KECCAK256_RATE];
+  padBlock(context->block, context->blockLength, block);
+  absorbBlock(context->state, 1, 0, block);
+  keccakF1600(context->state);
+  squeeze(context->state, 1, 0, out);
+  keccak256Init(context);
+}
+
+typedef struct {
+  size_t message;
+  size_t offset;
+  bool active;
+} lane_t;
+
+void keccak256Batch(const uint8_t *const *inputs, const size_t *lengths, size_t count, uint8_t (*outputs)[32]) {
+  const backend_t *backend = &BACKENDS[keccakGetBackend()];
+  const unsigned width = backend->width;
+  uint64_t words[25 * MAX_WIDTH];
+  lane_t lanes[MAX_WIDTH];
+  size_t next = 0;
+  unsigned active = 0;
+
+  memset(words, 0, sizeof(words));
+  for (unsigned lane = 0; lane < width; lane++) {
+    lanes[lane].active = (next < count);
+    lanes[lane].message = next++;
+    lanes[lane].offset = 0;
+    active += lanes[lane].active;
+  }
+  while (active != 0) {
+    uint8_t block[KECCAK256_RATE];
+    bool last[MAX_WIDTH];
+    for (unsigned lane = 0; lane < width; lane++) {
+      lane_t *current = &lanes[lane];
+      last[lane] = false;
+      if (!current->active) {
+        continue;
+      }
+      size_t remaining = lengths[current->message] - current->offset;
+      if (remaining >= KECCAK256_RATE) {
+        absorbBlock(words, width, lane, inputs[current->message] + current->offset);
+        current->offset += KECCAK256_RATE;
+      }
+      else {
+        padBlock(inputs[current->message] + current->offset, remaining, block);
+        absorbBlock(words, width, lane, block);
+        last[lane] = true;
+      }
+    }
+    backend->permute(words);
+    for (unsigned lane = 0; lane < width; lane++) {
+      lane_t *current = &lanes[lane];
+      if (!last[lane]) {
+        continue;
+      }
+      squeeze(words, width, lane, outputs[current->message]);
+      for (unsigned i = 0; i < 25; i++) {
+        words[i * width + lane] = 0;
+      }
+      // Refill the lane with the next message
+      if (next < count) {
+        current->message = next++;
+        current->offset = 0;
+      }
+      else {
+        current->active = false;
+        active--;
+      }
+    }
+  }
+}
@@ -0,0 +1,42 @@
+// Host Keccak-256 for the tests and host tools.
+//
+// The incremental API backs the host cx.h used to build ethUstream.c and
+// ethUtils.c. keccak256Batch hashes many independent messages, several at a
+// time with AVX2 (4 states) or AVX-512 (8 states) when the CPU supports it.
+
+#ifndef _HOST_KECCAK_H_
+#define _HOST_KECCAK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define KECCAK256_RATE 136
+
+typedef enum {
+  KECCAK_BACKEND_SCALAR,
+  KECCAK_BACKEND_AVX2,
+  KECCAK_BACKEND_AVX512,
+  KECCAK_BACKEND_COUNT
+} keccakBackend_e;
+
+typedef struct keccak256_t {
+  uint64_t state[25];
+  uint8_t block[KECCAK256_RATE];
+  size_t blockLength;
+} keccak256_t;
+
+void keccak256Init(keccak256_t *context);
+void keccak256Update(keccak256_t *context, const uint8_t *data, size_t length);
+void keccak256Final(keccak256_t *context, uint8_t *out);
+
+// Hashes count messages into outputs, 32 bytes each
+void keccak256Batch(const uint8_t *const *inputs, const size_t *lengths, size_t count, uint8_t (*outputs)[32]);
+
+bool keccakBackendSupported(keccakBackend_e backend);
+// Selects the batch backend, the best supported one is used by default
+bool keccakSetBackend(keccakBackend_e backend);
+keccakBackend_e keccakGetBackend(void);
+const char *keccakBackendName(keccakBackend_e backend);
+
+#endif // _HOST_KECCAK_H_
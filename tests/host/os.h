@@ -0,0 +1,12 @@
+// Host replacement for the BOLOS os.h, for the src_common files built by the
+// tests
+
+#ifndef _HOST_OS_H_
+#define _HOST_OS_H_
+
+#define PRINTF(...)
+
+// Data is not relocated on the host
+#define PIC(x) (x)
+
+#endif // _HOST_OS_H_
@@ -0,0 +1,289 @@
+// Differential oracle for the uint256 kernels.
+//
+// Usage: oracle_uint256 [random_cases]
+//
+// Runs edge-case and seeded random inputs through both the reference
+// uint256.c (see uint256_reference.c) and the build selected with the
+// UINT256_KERNELS CMake option, and compares every output bit for bit. One
+// CSV line is printed per function with the number of checks, mismatches and
+// the time per call of both builds. The exit status is non zero if any output
+// differs, so the target also runs as a regression gate under ctest.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "uint256.h"
+#include "uint256_reference.h"
+
+#define DEFAULT_RANDOM_CASES 4000
+#define STRING_LENGTH 100
+
+typedef enum {
+  OP_MUL256,
+  OP_DIVMOD256,
+  OP_TOSTRING256,
+  OP_SHIFTL256,
+  OP_SHIFTR256,
+  OP_ADD_MINUS256,
+  OP_COMPARE256,
+  OP_BITS256,
+  OP_MUL128,
+  OP_DIVMOD128,
+  OP_TOSTRING128,
+  OP_TOSTRING64,
+  OP_COUNT
+} operation_e;
+
+static const char *const OPERATION_NAMES[OP_COUNT] = {
+  "mul256", "divmod256", "tostring256", "shiftl256", "shiftr256", "add_minus256",
+  "compare256", "bits256", "mul128", "divmod128", "tostring128", "tostring64"
+};
+
+typedef struct {
+  uint64_t calls;
+  uint64_t checks;
+  uint64_t mismatches;
+  uint64_t refNs;
+  uint64_t selectedNs;
+} report_t;
+
+static report_t reports[OP_COUNT];
+static uint64_t rngState = 0x2545f4914f6cdd1dULL;
+
+static uint64_t rng(void) {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 7;
+  rngState ^= rngState << 17;
+  return rngState;
+}
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void dump(const char *label, const void *data, size_t length) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  fprintf(stderr, "  %s ", label);
+  for (size_t i = 0; i < length; i++) {
+    fprintf(stderr, "%02x", bytes[i]);
+  }
+  fprintf(stderr, "\n");
+}
+
+static void check(operation_e op, const void *ref, const void *selected, size_t length,
+                  const uint256_t *a, const uint256_t *b) {
+  reports[op].checks++;
+  if (memcmp(ref, selected, length) != 0) {
+    // Only the first few mismatches of each kind are detailed
+    if (reports[op].mismatches++ < 4) {
+      fprintf(stderr, "%s mismatch\n", OPERATION_NAMES[op]);
+      dump("a", a, sizeof(uint256_t));
+      dump("b", b, sizeof(uint256_t));
+      dump("reference", ref, length);
+      dump("selected", selected, length);
+    }
+  }
+}
+
+// Calls are timed one by one: the uint256 primitives are long enough for the
+// clock overhead, identical on both sides, not to hide the difference
+#define TIMED(op, refCall, selectedCall) do { \
+    uint64_t start = nowNs(); \
+    refCall; \
+    uint64_t middle = nowNs(); \
+    selectedCall; \
+    reports[op].selectedNs += nowNs() - middle; \
+    reports[op].refNs += middle - start; \
+    reports[op].calls++; \
+  } while (0)
+
+static void lower128(const uint256_t *number, uint128_t *target) {
+  UPPER_P(target) = number->elements[2];
+  LOWER_P(target) = number->elements[3];
+}
+
+static void runCase(const uint256_t *a, const uint256_t *b, uint32_t shift, uint32_t base) {
+  uint256_t refResult, result, refMod, mod, l, r;
+  uint128_t a128, b128, refResult128, result128, refMod128, mod128, l128, r128;
+  char refString[STRING_LENGTH], string[STRING_LENGTH];
+  bool refStatus, status;
+
+  TIMED(OP_MUL256,
+        ref_mul256(a, b, &refResult),
+        mul256(a, b, &result));
+  check(OP_MUL256, &refResult, &result, sizeof(result), a, b);
+
+  // The reference does not terminate on a zero divisor
+  if (!ref_zero256(b)) {
+    copy256(&l, a);
+    copy256(&r, b);
+    TIMED(OP_DIVMOD256,
+          ref_divmod256(&l, &r, &refResult, &refMod),
+          divmod256(&l, &r, &result, &mod));
+    check(OP_DIVMOD256, &refResult, &result, sizeof(result), a, b);
+    check(OP_DIVMOD256, &refMod, &mod, sizeof(mod), a, b);
+    // In place division, as done by the string conversions
+    copy256(&result, a);
+    divmod256(&result, &r, &result, &mod);
+    check(OP_DIVMOD256, &refResult, &result, sizeof(result), a, b);
+    check(OP_DIVMOD256, &refMod, &mod, sizeof(mod), a, b);
+  }
+
+  memset(refString, 0, sizeof(refString));
+  memset(string, 0, sizeof(string));
+  TIMED(OP_TOSTRING256,
+        refStatus = ref_tostring256(a, base, refString, sizeof(refString)),
+        status = tostring256(a, base, string, sizeof(string)));
+  check(OP_TOSTRING256, &refStatus, &status, sizeof(status), a, b);
+  check(OP_TOSTRING256, refString, string, sizeof(string), a, b);
+  // Truncated output buffer
+  memset(refString, 0, sizeof(refString));
+  memset(string, 0, sizeof(string));
+  refStatus = ref_tostring256(a, base, refString, 1 + shift % 20);
+  status = tostring256(a, base, string, 1 + shift % 20);
+  check(OP_TOSTRING256, &refStatus, &status, sizeof(status), a, b);
+  if (refStatus) {
+    check(OP_TOSTRING256, refString, string, sizeof(string), a, b);
+  }
+
+  TIMED(OP_SHIFTL256,
+        ref_shiftl256(a, shift, &refResult),
+        shiftl256(a, shift, &result));
+  check(OP_SHIFTL256, &refResult, &result, sizeof(result), a, b);
+
+  TIMED(OP_SHIFTR256,
+        ref_shiftr256(a, shift, &refResult),
+        shiftr256(a, shift, &result));
+  check(OP_SHIFTR256, &refResult, &result, sizeof(result), a, b);
+
+  TIMED(OP_ADD_MINUS256,
+        ref_add256(a, b, &refResult),
+        add256(a, b, &result));
+  check(OP_ADD_MINUS256, &refResult, &result, sizeof(result), a, b);
+  TIMED(OP_ADD_MINUS256,
+        ref_minus256(a, b, &refResult),
+        minus256(a, b, &result));
+  check(OP_ADD_MINUS256, &refResult, &result, sizeof(result), a, b);
+
+  bool refCompare[3], compare[3];
+  TIMED(OP_COMPARE256,
+        (refCompare[0] = ref_gt256(a, b), refCompare[1] = ref_gte256(a, b),
+         refCompare[2] = ref_equal256(a, b)),
+        (compare[0] = gt256(a, b), compare[1] = gte256(a, b),
+         compare[2] = equal256(a, b)));
+  check(OP_COMPARE256, refCompare, compare, sizeof(compare), a, b);
+
+  uint32_t refBits, bits;
+  TIMED(OP_BITS256,
+        refBits = ref_bits256(a),
+        bits = bits256(a));
+  check(OP_BITS256, &refBits, &bits, sizeof(bits), a, b);
+
+  lower128(a, &a128);
+  lower128(b, &b128);
+  TIMED(OP_MUL128,
+        ref_mul128(&a128, &b128, &refResult128),
+        mul128(&a128, &b128, &result128));
+  check(OP_MUL128, &refResult128, &result128, sizeof(result128), a, b);
+
+  if (!ref_zero128(&b128)) {
+    copy128(&l128, &a128);
+    copy128(&r128, &b128);
+    TIMED(OP_DIVMOD128,
+          ref_divmod128(&l128, &r128, &refResult128, &refMod128),
+          divmod128(&l128, &r128, &result128, &mod128));
+    check(OP_DIVMOD128, &refResult128, &result128, sizeof(result128), a, b);
+    check(OP_DIVMOD128, &refMod128, &mod128, sizeof(mod128), a, b);
+  }
+
+  memset(refString, 0, sizeof(refString));
+  memset(string, 0, sizeof(string));
+  TIMED(OP_TOSTRING128,
+        refStatus = ref_tostring128(&a128, base, refString, sizeof(refString)),
+        status = tostring128(&a128, base, string, sizeof(string)));
+  check(OP_TOSTRING128, &refStatus, &status, sizeof(status), a, b);
+  check(OP_TOSTRING128, refString, string, sizeof(string), a, b);
+
+  memset(refString, 0, sizeof(refString));
+  memset(string, 0, sizeof(string));
+  TIMED(OP_TOSTRING64,
+        refStatus = ref_tostring64(a->elements[3], base, refString, sizeof(refString)),
+        status = tostring64(a->elements[3], base, string, sizeof(string)));
+  check(OP_TOSTRING64, &refStatus, &status, sizeof(status), a, b);
+  check(OP_TOSTRING64, refString, string, sizeof(string), a, b);
+}
+
+// Values at the limb and word boundaries, where carries, borrows and
+// normalization shifts change behaviour
+static void edgeValue(uint32_t index, uint256_t *target) {
+  static const uint64_t LIMB_VALUES[] = {
+    0, 1, 2, 9, 10, 0xffffffffULL, 0x100000000ULL, 0x7fffffffffffffffULL,
+    0x8000000000000000ULL, 0xffffffffffffffffULL, 1000000000000000000ULL
+  };
+  const uint32_t count = sizeof(LIMB_VALUES) / sizeof(LIMB_VALUES[0]);
+  clear256(target);
+  if (index < count * UINT256_LIMBS) {
+    // A single limb set
+    target->elements[index / count] = LIMB_VALUES[index % count];
+  } else {
+    // All limbs set to the same value
+    for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+      target->elements[i] = LIMB_VALUES[(index - count * UINT256_LIMBS) % count];
+    }
+  }
+}
+
+#define EDGE_VALUES (11 * (UINT256_LIMBS + 1))
+
+// Random value with a random number of significant bits, so that every
+// operand size and limb count gets covered
+static void randomValue(uint256_t *target) {
+  uint256_t full;
+  for (uint32_t i = 0; i < UINT256_LIMBS; i++) {
+    full.elements[i] = rng();
+  }
+  shiftr256(&full, rng() % 256, target);
+}
+
+int main(int argc, char **argv) {
+  static const uint32_t BASES[] = {10, 16, 2, 7};
+  uint32_t randomCases = DEFAULT_RANDOM_CASES;
+  uint64_t mismatches = 0;
+  uint256_t a, b;
+
+  if (argc > 1) {
+    randomCases = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+
+  for (uint32_t i = 0; i < EDGE_VALUES; i++) {
+    for (uint32_t j = 0; j < EDGE_VALUES; j++) {
+      edgeValue(i, &a);
+      edgeValue(j, &b);
+      runCase(&a, &b, (i * 31 + j) % 257, BASES[(i + j) % 4]);
+    }
+  }
+  for (uint32_t i = 0; i < randomCases; i++) {
+    randomValue(&a);
+    randomValue(&b);
+    runCase(&a, &b, rng() % 257, BASES[i % 4]);
+  }
+
+  printf("kernel,checks,mismatches,reference_ns_per_call,selected_ns_per_call,speedup\n");
+  for (uint32_t op = 0; op < OP_COUNT; op++) {
+    const report_t *report = &reports[op];
+    double refNs = (double)report->refNs / report->calls;
+    double selectedNs = (double)report->selectedNs / report->calls;
+    printf("%s,%llu,%llu,%.2f,%.2f,%.2f\n", OPERATION_NAMES[op],
+           (unsigned long long)report->checks, (unsigned long long)report->mismatches,
+           refNs, selectedNs, selectedNs > 0 ? refNs / selectedNs : 0.0);
+    mismatches += report->mismatches;
+  }
+  return (mismatches == 0 ? 0 : 1);
+}
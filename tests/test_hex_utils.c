@@ -0,0 +1,77 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "hexUtils.h"
+
+static const uint8_t ADDRESS[20] = {
+  0x5a, 0xae, 0xb6, 0x05, 0x3f, 0x3e, 0x94, 0xc9, 0xb9, 0xa0,
+  0x9f, 0x33, 0x66, 0x94, 0x35, 0xe7, 0xef, 0x1b, 0xea, 0xed
+};
+
+static void test_encode(void **state) {
+  (void) state;
+  char out[41];
+
+  hexEncode(ADDRESS, sizeof(ADDRESS), out);
+  assert_string_equal(out, "5AAEB6053F3E94C9B9A09F33669435E7EF1BEAED");
+  hexEncodeLowercase(ADDRESS, sizeof(ADDRESS), out);
+  assert_string_equal(out, "5aaeb6053f3e94c9b9a09f33669435e7ef1beaed");
+
+  hexEncode(ADDRESS, 0, out);
+  assert_string_equal(out, "");
+}
+
+static void test_all_bytes(void **state) {
+  (void) state;
+  static const char DIGITS[] = "0123456789ABCDEF";
+  uint8_t data[256];
+  char out[513];
+
+  for (int i = 0; i < 256; i++) {
+    data[i] = i;
+  }
+  hexEncode(data, sizeof(data), out);
+  for (int i = 0; i < 256; i++) {
+    assert_int_equal(out[2 * i], DIGITS[i >> 4]);
+    assert_int_equal(out[2 * i + 1], DIGITS[i & 0x0f]);
+  }
+  for (int i = 0; i < 16; i++) {
+    assert_int_equal(hexDigit(i), "0123456789abcdef"[i]);
+  }
+}
+
+static void test_checksum(void **state) {
+  (void) state;
+  char out[41];
+
+  // Nibbles of 8 where the EIP-55 test vector has an uppercase letter, the
+  // digits must not be affected
+  static const uint8_t HASH[20] = {
+    0x00, 0x80, 0x00, 0x00, 0x08, 0x08, 0x00, 0x80, 0x00, 0x80,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x08, 0x08, 0x00
+  };
+  hexEncodeChecksum(ADDRESS, sizeof(ADDRESS), HASH, out);
+  assert_string_equal(out, "5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAed");
+
+  uint8_t hash[20];
+  memset(hash, 0xff, sizeof(hash));
+  hexEncodeChecksum(ADDRESS, sizeof(ADDRESS), hash, out);
+  assert_string_equal(out, "5AAEB6053F3E94C9B9A09F33669435E7EF1BEAED");
+  memset(hash, 0x77, sizeof(hash));
+  hexEncodeChecksum(ADDRESS, sizeof(ADDRESS), hash, out);
+  assert_string_equal(out, "5aaeb6053f3e94c9b9a09f33669435e7ef1beaed");
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_encode),
+      cmocka_unit_test(test_all_bytes),
+      cmocka_unit_test(test_checksum),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,138 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "keccak.h"
+#include "cx.h"
+#include "ethUtils.h"
+
+#define BATCH_SIZE 37
+#define MAX_LENGTH 600
+
+static const uint8_t EMPTY_HASH[32] = {
+  0xc5, 0xd2, 0x46, 0x01, 0x86, 0xf7, 0x23, 0x3c, 0x92, 0x7e, 0x7d, 0xb2,
+  0xdc, 0xc7, 0x03, 0xc0, 0xe5, 0x00, 0xb6, 0x53, 0xca, 0x82, 0x27, 0x3b,
+  0x7b, 0xfa, 0xd8, 0x04, 0x5d, 0x85, 0xa4, 0x70
+};
+
+static const uint8_t ABC_HASH[32] = {
+  0x4e, 0x03, 0x65, 0x7a, 0xea, 0x45, 0xa9, 0x4f, 0xc7, 0xd4, 0x7b, 0xa8,
+  0x26, 0xc8, 0xd6, 0x67, 0xc0, 0xd1, 0xe6, 0xe3, 0x3a, 0x64, 0xa0, 0x36,
+  0xec, 0x44, 0xf5, 0x8f, 0xa1, 0x2d, 0x6c, 0x45
+};
+
+static void test_vectors(void **state) {
+  (void) state;
+  cx_sha3_t sha3;
+  uint8_t hash[32];
+
+  cx_keccak_init(&sha3, 256);
+  cx_hash((cx_hash_t*)&sha3, CX_LAST, NULL, 0, hash, 32);
+  assert_memory_equal(hash, EMPTY_HASH, 32);
+
+  // Same message, fed in several updates
+  cx_keccak_init(&sha3, 256);
+  cx_hash((cx_hash_t*)&sha3, 0, (const uint8_t *) "a", 1, NULL, 0);
+  cx_hash((cx_hash_t*)&sha3, CX_LAST, (const uint8_t *) "bc", 2, hash, 32);
+  assert_memory_equal(hash, ABC_HASH, 32);
+}
+
+static void test_checksum(void **state) {
+  (void) state;
+  static const uint8_t ADDRESS[20] = {
+    0x5a, 0xae, 0xb6, 0x05, 0x3f, 0x3e, 0x94, 0xc9, 0xb9, 0xa0,
+    0x9f, 0x33, 0x66, 0x94, 0x35, 0xe7, 0xef, 0x1b, 0xea, 0xed
+  };
+  cx_sha3_t sha3;
+  char out[41];
+
+  getEthAddressStringFromBinary(ADDRESS, out, 42220, &sha3);
+  assert_string_equal(out, "5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAed");
+}
+
+// adjustDecimals of the digits, then truncateDecimals to four significant
+// digits. truncated tells whether the review marks the amount with a ~.
+static void checkTruncation(const char *digits, uint8_t decimals,
+                            const char *expected, bool truncated) {
+  char amount[40];
+
+  assert_true(adjustDecimals(digits, strlen(digits), amount, sizeof(amount), decimals));
+  assert_int_equal(truncateDecimals(amount, 4), truncated);
+  assert_string_equal(amount, expected);
+}
+
+static void test_truncate_decimals(void **state) {
+  (void) state;
+
+  // Trailing zeros are removed by adjustDecimals, and do not count
+  checkTruncation("1500000", 6, "1.5", false);
+  checkTruncation("12300000000", 10, "1.23", false);
+  // Zeros left at the end of the kept digits are removed
+  checkTruncation("12300045", 7, "1.23", true);
+  // Exact fit, leading zeros are not significant
+  checkTruncation("1234", 2, "12.34", false);
+  checkTruncation("1234", 6, "0.001234", false);
+  // Truncated past four significant digits
+  checkTruncation("123456789", 6, "123.4", true);
+  checkTruncation("12345", 7, "0.001234", true);
+  // The integer part is always kept, without a trailing point
+  checkTruncation("12345678", 2, "123456", true);
+  // Zero decimals, nothing to drop
+  checkTruncation("123456", 0, "123456", false);
+  checkTruncation("0", 0, "0", false);
+  checkTruncation("0", 18, "0", false);
+}
+
+static void test_batch(void **state) {
+  (void) state;
+  static uint8_t data[BATCH_SIZE][MAX_LENGTH];
+  const uint8_t *inputs[BATCH_SIZE];
+  size_t lengths[BATCH_SIZE];
+  uint8_t expected[BATCH_SIZE][32];
+  uint8_t outputs[BATCH_SIZE][32];
+  keccak256_t context;
+  uint32_t seed = 1;
+  keccakBackend_e defaultBackend = keccakGetBackend();
+
+  for (int i = 0; i < BATCH_SIZE; i++) {
+    // Lengths around the block boundaries, then arbitrary ones
+    lengths[i] = (i < 8 ? (size_t) (KECCAK256_RATE * (i / 2) + (i % 2 ? 1 : 0) - (i == 2 ? 1 : 0))
+                        : (seed = seed * 1103515245 + 12345) % MAX_LENGTH);
+    for (size_t j = 0; j < lengths[i]; j++) {
+      data[i][j] = (uint8_t) ((seed = seed * 1103515245 + 12345) >> 16);
+    }
+    inputs[i] = data[i];
+    keccak256Init(&context);
+    keccak256Update(&context, inputs[i], lengths[i]);
+    keccak256Final(&context, expected[i]);
+  }
+
+  for (int backend = 0; backend < KECCAK_BACKEND_COUNT; backend++) {
+    if (!keccakSetBackend(backend)) {
+      printf("skipping unsupported %s backend\n", keccakBackendName(backend));
+      continue;
+    }
+    memset(outputs, 0, sizeof(outputs));
+    keccak256Batch(inputs, lengths, BATCH_SIZE, outputs);
+    assert_memory_equal(outputs, expected, sizeof(expected));
+    // Fewer messages than lanes
+    memset(outputs, 0, sizeof(outputs));
+    keccak256Batch(inputs, lengths, 3, outputs);
+    assert_memory_equal(outputs, expected, 3 * 32);
+  }
+  keccakSetBackend(defaultBackend);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_vectors),
+      cmocka_unit_test(test_checksum),
+      cmocka_unit_test(test_truncate_decimals),
+      cmocka_unit_test(test_batch),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,116 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "tokenCache.h"
+
+// Token i, whose address hashes to the home slot of its last byte
+static void makeToken(tokenDefinition_t *token, uint8_t i, uint8_t last) {
+  memset(token, 0, sizeof(tokenDefinition_t));
+  memset(token->address, i, 18);
+  token->address[19] = last;
+  token->decimals = i;
+}
+
+static void test_lookup(void **state) {
+  (void) state;
+  tokenDefinition_t token;
+  tokenDefinition_t *cached;
+
+  clearTokenCache();
+  makeToken(&token, 1, 1);
+  assert_null(lookupCachedToken(token.address));
+  cached = cacheToken(&token);
+  assert_memory_equal(cached, &token, sizeof(token));
+  assert_true(lookupCachedToken(token.address) == cached);
+  // A new descriptor of the same address replaces the cached one
+  token.decimals = 6;
+  assert_true(cacheToken(&token) == cached);
+  assert_int_equal(lookupCachedToken(token.address)->decimals, 6);
+}
+
+static void test_collisions(void **state) {
+  (void) state;
+  tokenDefinition_t token;
+
+  clearTokenCache();
+  // All in the same home slot
+  for (uint8_t i = 1; i <= 4; i++) {
+    makeToken(&token, i, 0);
+    cacheToken(&token);
+  }
+  for (uint8_t i = 1; i <= 4; i++) {
+    makeToken(&token, i, 0);
+    assert_non_null(lookupCachedToken(token.address));
+    assert_int_equal(lookupCachedToken(token.address)->decimals, i);
+  }
+  makeToken(&token, 5, 0);
+  assert_null(lookupCachedToken(token.address));
+}
+
+static void test_eviction(void **state) {
+  (void) state;
+  tokenDefinition_t token;
+
+  clearTokenCache();
+  for (uint16_t i = 0; i < TOKEN_CACHE_SIZE; i++) {
+    makeToken(&token, i + 1, i);
+    cacheToken(&token);
+  }
+  // The first token is used again, the second one becomes the oldest
+  makeToken(&token, 1, 0);
+  assert_non_null(lookupCachedToken(token.address));
+  makeToken(&token, 200, 7);
+  cacheToken(&token);
+  assert_non_null(lookupCachedToken(token.address));
+  makeToken(&token, 2, 1);
+  assert_null(lookupCachedToken(token.address));
+  for (uint16_t i = 2; i < TOKEN_CACHE_SIZE; i++) {
+    makeToken(&token, i + 1, i);
+    assert_non_null(lookupCachedToken(token.address));
+  }
+  makeToken(&token, 1, 0);
+  assert_non_null(lookupCachedToken(token.address));
+}
+
+static void test_eviction_in_chain(void **state) {
+  (void) state;
+  tokenDefinition_t token;
+
+  clearTokenCache();
+  // One chain from the last slot, wrapping around, then the tokens homed in
+  // the slots it went through
+  for (uint16_t i = 0; i < TOKEN_CACHE_SIZE / 2; i++) {
+    makeToken(&token, i + 1, TOKEN_CACHE_SLOTS - 1);
+    cacheToken(&token);
+  }
+  for (uint16_t i = TOKEN_CACHE_SIZE / 2; i < TOKEN_CACHE_SIZE; i++) {
+    makeToken(&token, i + 1, i - TOKEN_CACHE_SIZE / 2);
+    cacheToken(&token);
+  }
+  // Removing the head of the chain moves back the entries after it
+  makeToken(&token, 200, 3);
+  cacheToken(&token);
+  makeToken(&token, 1, TOKEN_CACHE_SLOTS - 1);
+  assert_null(lookupCachedToken(token.address));
+  for (uint16_t i = 1; i < TOKEN_CACHE_SIZE; i++) {
+    makeToken(&token, i + 1, (i < TOKEN_CACHE_SIZE / 2) ? TOKEN_CACHE_SLOTS - 1 : i - TOKEN_CACHE_SIZE / 2);
+    assert_non_null(lookupCachedToken(token.address));
+    assert_int_equal(lookupCachedToken(token.address)->decimals, i + 1);
+  }
+  makeToken(&token, 200, 3);
+  assert_non_null(lookupCachedToken(token.address));
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_lookup),
+    cmocka_unit_test(test_collisions),
+    cmocka_unit_test(test_eviction),
+    cmocka_unit_test(test_eviction_in_chain),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,56 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "tokensList.h"
+
+static const uint8_t CUSD[20] = {
+  0x76, 0x5d, 0xe8, 0x16, 0x84, 0x58, 0x61, 0xe7, 0x5a, 0x25,
+  0xfc, 0xa1, 0x22, 0xbb, 0x68, 0x98, 0xb8, 0xb1, 0x28, 0x2a
+};
+
+static const uint8_t CREAL[20] = {
+  0xe8, 0x53, 0x7a, 0x3d, 0x05, 0x6d, 0xa4, 0x46, 0x67, 0x7b,
+  0x9e, 0x9d, 0x6c, 0x5d, 0xb7, 0x04, 0xea, 0xab, 0x47, 0x87
+};
+
+static void test_builtin(void **state) {
+  (void) state;
+  const tokenDefinition_t *token;
+
+  token = getBuiltinToken(CUSD);
+  assert_non_null(token);
+  assert_string_equal(token->ticker, "cUSD ");
+  assert_int_equal(token->decimals, 18);
+  token = getBuiltinToken(CREAL);
+  assert_non_null(token);
+  assert_string_equal(token->ticker, "cREAL ");
+}
+
+static void test_unknown(void **state) {
+  (void) state;
+  uint8_t address[20];
+
+  memset(address, 0, sizeof(address));
+  assert_null(getBuiltinToken(address));
+  // Same hashed bytes as a built in token, other address
+  memcpy(address, CUSD, sizeof(address));
+  address[19] ^= 0x01;
+  assert_null(getBuiltinToken(address));
+  // Every slot is either empty or checked against the full address
+  for (int i = 0; i < 256; i++) {
+    memset(address, i, sizeof(address));
+    assert_null(getBuiltinToken(address));
+  }
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_builtin),
+    cmocka_unit_test(test_unknown),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,128 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "ethUtils.h"
+#include "txIntUtils.h"
+
+static const char MAX_UINT256[] =
+  "115792089237316195423570985008687907853269984665640564039457584007913129639935";
+
+static void test_to_string(void **state) {
+  (void) state;
+  uint8_t data[32];
+  char out[80];
+
+  // Zero, empty or with leading zero bytes
+  assert_true(txIntToString(data, 0, out, sizeof(out)));
+  assert_string_equal(out, "0");
+  memset(data, 0, sizeof(data));
+  assert_true(txIntToString(data, 32, out, sizeof(out)));
+  assert_string_equal(out, "0");
+
+  // 64, 128 and 256 bits paths
+  data[31] = 42;
+  assert_true(txIntToString(data, 32, out, sizeof(out)));
+  assert_string_equal(out, "42");
+  memset(data, 0, sizeof(data));
+  data[23] = 1;
+  assert_true(txIntToString(data, 32, out, sizeof(out)));
+  assert_string_equal(out, "18446744073709551616");
+  memset(data, 0xff, sizeof(data));
+  assert_true(txIntToString(data, 32, out, sizeof(out)));
+  assert_string_equal(out, MAX_UINT256);
+
+  // The output buffer is too short for the digits and the terminating zero
+  assert_false(txIntToString(data, 32, out, sizeof(MAX_UINT256) - 1));
+  assert_true(txIntToString(data, 32, out, sizeof(MAX_UINT256)));
+}
+
+static void test_product_to_string(void **state) {
+  (void) state;
+  uint8_t data1[32];
+  uint8_t data2[32];
+  char out[80];
+
+  memset(data1, 0, sizeof(data1));
+  memset(data2, 0, sizeof(data2));
+  data1[31] = 21;
+  assert_true(txIntProductToString(data1, 32, data2, 0, out, sizeof(out)));
+  assert_string_equal(out, "0");
+  data2[31] = 2;
+  assert_true(txIntProductToString(data1, 32, data2, 32, out, sizeof(out)));
+  assert_string_equal(out, "42");
+
+  // 64 bits operands overflowing 64 bits
+  memset(data1, 0xff, 8);
+  assert_true(txIntProductToString(data1, 8, data1, 8, out, sizeof(out)));
+  assert_string_equal(out, "340282366920938463426481119284349108225");
+  // 128 bits operands, the product still fits 256 bits
+  memset(data1, 0xff, 16);
+  assert_true(txIntProductToString(data1, 16, data1, 16, out, sizeof(out)));
+  assert_string_equal(out, "115792089237316195423570985008687907852589419931798687112530834793049593217025");
+
+  // 2^200 * 2^60 wraps, which callers rule out with txIntBits
+  memset(data1, 0, sizeof(data1));
+  memset(data2, 0, sizeof(data2));
+  data1[6] = 1;
+  data2[24] = 0x10;
+  assert_int_equal(txIntBits(data1, 32), 201);
+  assert_int_equal(txIntBits(data2, 32), 61);
+  assert_true(txIntProductToString(data1, 32, data2, 32, out, sizeof(out)));
+  assert_string_equal(out, "0");
+}
+
+static void test_bits(void **state) {
+  (void) state;
+  uint8_t data[32];
+
+  memset(data, 0, sizeof(data));
+  assert_int_equal(txIntBits(data, 0), 0);
+  assert_int_equal(txIntBits(data, 32), 0);
+  data[31] = 1;
+  assert_int_equal(txIntBits(data, 32), 1);
+  data[30] = 0x80;
+  assert_int_equal(txIntBits(data, 32), 16);
+  memset(data, 0xff, sizeof(data));
+  assert_int_equal(txIntBits(data, 32), 256);
+}
+
+// Decimal rendering followed by the decimal point, as in the review screens
+static void checkAmount(const uint8_t *data, uint32_t length, uint8_t decimals, const char *expected) {
+  char digits[80];
+  char amount[100];
+
+  assert_true(txIntToString(data, length, digits, sizeof(digits)));
+  assert_true(adjustDecimals(digits, strlen(digits), amount, sizeof(amount), decimals));
+  assert_string_equal(amount, expected);
+}
+
+static void test_decimals(void **state) {
+  (void) state;
+  static const uint8_t ONE[] = { 0x01 };
+  static const uint8_t ONE_ETHER[] = { 0x0d, 0xe0, 0xb6, 0xb3, 0xa7, 0x64, 0x00, 0x00 };
+  static const uint8_t GWEI_1_5[] = { 0x59, 0x68, 0x2f, 0x00 };
+  uint8_t max[32];
+
+  checkAmount(ONE, 0, 18, "0");
+  checkAmount(ONE, 1, 18, "0.000000000000000001");
+  checkAmount(ONE, 1, 0, "1");
+  checkAmount(ONE_ETHER, sizeof(ONE_ETHER), 18, "1");
+  checkAmount(GWEI_1_5, sizeof(GWEI_1_5), 9, "1.5");
+  memset(max, 0xff, sizeof(max));
+  checkAmount(max, sizeof(max), 18,
+              "115792089237316195423570985008687907853269984665640564039457.584007913129639935");
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_to_string),
+    cmocka_unit_test(test_product_to_string),
+    cmocka_unit_test(test_bits),
+    cmocka_unit_test(test_decimals),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -9,23 +9,23 @@
 #define assert_uint256_equal(a, b) assert_memory_equal((a), (b), sizeof(uint256_t))
 
 static void uint256_from_uint(uint256_t *n, uint64_t v) {
-  n->elements[0].elements[0] = 0;
-  n->elements[0].elements[1] = 0;
-  n->elements[1].elements[0] = 0;
-  n->elements[1].elements[1] = v;
+  n->elements[0] = 0;
+  n->elements[1] = 0;
+  n->elements[2] = 0;
+  n->elements[3] = v;
 }
 
 static void test_bitshift_right(void **state) {
   (void) state;
-  const uint256_t val = {0, 0, 0, 0xffffffffffffffffULL};
+  const uint256_t val = {{0, 0, 0, 0xffffffffffffffffULL}};
   uint256_t r;
   for (int i = 0; i < 64; i++) {
-    uint256_t expected = {0, 0, 0, 0xffffffffffffffffULL >> i};
+    uint256_t expected = {{0, 0, 0, 0xffffffffffffffffULL >> i}};
     shiftr256(&val, i, &r);
     assert_uint256_equal(&r, &expected);
   }
 
-  const uint256_t zero = {0};
+  const uint256_t zero = {{0}};
   for (int i = 0; i < 64; i++) {
     shiftr256(&zero, i, &r);
     assert_uint256_equal(&r, &zero);
@@ -45,7 +45,7 @@ static void test_bitshift_left(void **state) {
     assert_uint256_equal(&r, &expected);
   }
 
-  const uint256_t zero = {0};
+  const uint256_t zero = {{0}};
   for (int i = 0; i < 64; i++) {
     shiftl256(&zero, i, &r);
     assert_uint256_equal(&r, &zero);
@@ -54,8 +54,8 @@ static void test_bitshift_left(void **state) {
 
 static void test_external_shift_right(void **state) {
   (void) state;
-  uint256_t t = {0, 0, 0, 1};
-  uint256_t f = {0};
+  uint256_t t = {{0, 0, 0, 1}};
+  uint256_t f = {{0}};
   uint256_t u8, u16, u32, u64;
 
   uint256_from_uint(&u8, 0xffULL);
@@ -63,8 +63,8 @@ static void test_external_shift_right(void **state) {
   uint256_from_uint(&u32, 0xffffffffULL);
   uint256_from_uint(&u64, 0xffffffffffffffffULL);
 
-  const uint256_t zero = {0};
-  const uint256_t one = {0, 0, 0, 1};
+  const uint256_t zero = {{0}};
+  const uint256_t one = {{0, 0, 0, 1}};
 
   uint256_t r;
   shiftr256(&t, 0, &r);
@@ -111,18 +111,18 @@ static void test_external_shift_right(void **state) {
 static void test_external_shift_left(void **state) {
   (void) state;
 
-  uint256_t t = {0, 0, 0, 1};
-  uint256_t f = {0};
+  uint256_t t = {{0, 0, 0, 1}};
+  uint256_t f = {{0}};
   uint256_t u8, u16, u32, u64;
 
   uint256_from_uint(&u8, 0x7fULL);
   uint256_from_uint(&u16, 0x7fffULL);
   uint256_from_uint(&u32, 0x7fffffffULL);
   uint256_from_uint(&u64, 0x7fffffffffffffffULL);
-  uint256_t u128 = {0, 0, 0x7fffffffffffffffULL, 0xffffffffffffffffULL};
+  uint256_t u128 = {{0, 0, 0x7fffffffffffffffULL, 0xffffffffffffffffULL}};
 
-  const uint256_t zero = {0};
-  const uint256_t one = {0, 0, 0, 1};
+  const uint256_t zero = {{0}};
+  const uint256_t one = {{0, 0, 0, 1}};
 
   uint256_t r;
   shiftl256(&t, 0, &r);
@@ -150,7 +150,7 @@ static void test_external_shift_left(void **state) {
   shiftl256(&u64, 1, &u64);
   uint256_from_uint(&r, 0xfffffffffffffffeULL);
   assert_uint256_equal(&u64, &r);
-  uint256_t expected_r128 = {0, 0, 0xffffffffffffffffULL, 0xfffffffffffffffeULL};
+  uint256_t expected_r128 = {{0, 0, 0xffffffffffffffffULL, 0xfffffffffffffffeULL}};
   shiftl256(&u128, 1, &u128);
   assert_uint256_equal(&u128, &expected_r128);
 
@@ -168,24 +168,24 @@ static void test_external_shift_left(void **state) {
   assert_uint256_equal(&r, &r1);
 
   shiftl256(&u64, 63, &r1);
-  uint256_t r2 = {0, 0, 0x7fffffffffffffffULL, 0};
+  uint256_t r2 = {{0, 0, 0x7fffffffffffffffULL, 0}};
   assert_uint256_equal(&r1, &r2);
 
   shiftl256(&u128, 127, &r1);
-  uint256_t r3 = {0x7fffffffffffffffULL, 0xffffffffffffffffULL, 0x0000000000000000ULL, 0x0000000000000000ULL};
+  uint256_t r3 = {{0x7fffffffffffffffULL, 0xffffffffffffffffULL, 0x0000000000000000ULL, 0x0000000000000000ULL}};
   assert_uint256_equal(&r1, &r3);
 }
 
 static void test_arithmetic_multiply(void **state) {
   (void) state;
 
-  const uint256_t val = {0, 0, 0, 0xfedbca9876543210ULL};
-  const uint256_t zero = {0};
-  const uint256_t one = {0, 0, 0, 1};
+  const uint256_t val = {{0, 0, 0, 0xfedbca9876543210ULL}};
+  const uint256_t zero = {{0}};
+  const uint256_t one = {{0, 0, 0, 1}};
 
   uint256_t r1, r2, r3, r4, r5;
 
-  const uint256_t expected_r1 = {0x0000000000000000ULL, 0x0000000000000000ULL, 0xfdb8e2bacbfe7cefULL, 0x010e6cd7a44a4100ULL};
+  const uint256_t expected_r1 = {{0x0000000000000000ULL, 0x0000000000000000ULL, 0xfdb8e2bacbfe7cefULL, 0x010e6cd7a44a4100ULL}};
   mul256(&val, &val, &r1);
   assert_uint256_equal(&r1, &expected_r1);
 
@@ -203,46 +203,170 @@ static void test_arithmetic_multiply(void **state) {
 static void test_external_multiply(void **state) {
   (void) state;
 
-  const uint256_t f = {0};
-  const uint256_t t = {0, 0, 0, 1};
-  const uint256_t u8 = {0, 0, 0, 0xaa};
-  const uint256_t u16 = {0, 0, 0, 0xaaaa};
-  const uint256_t u32 = {0, 0, 0, 0xaaaaaaaa};
-  const uint256_t u64 = {0, 0, 0, 0xaaaaaaaaaaaaaaaaULL};
-  const uint256_t u128 = {0, 0, 0xaaaaaaaaaaaaaaaaULL, 0xaaaaaaaaaaaaaaaaULL};
-  const uint256_t val  = {0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL};
+  const uint256_t f = {{0}};
+  const uint256_t t = {{0, 0, 0, 1}};
+  const uint256_t u8 = {{0, 0, 0, 0xaa}};
+  const uint256_t u16 = {{0, 0, 0, 0xaaaa}};
+  const uint256_t u32 = {{0, 0, 0, 0xaaaaaaaa}};
+  const uint256_t u64 = {{0, 0, 0, 0xaaaaaaaaaaaaaaaaULL}};
+  const uint256_t u128 = {{0, 0, 0xaaaaaaaaaaaaaaaaULL, 0xaaaaaaaaaaaaaaaaULL}};
+  const uint256_t val  = {{0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL}};
 
   uint256_t r1, r2, r3, r4, r5, r6, r7;
 
-  const uint256_t expected_r1 = {0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL};
+  const uint256_t expected_r1 = {{0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL}};
   mul256(&t, &val, &r1);
   assert_uint256_equal(&r1, &expected_r1);
 
-  const uint256_t expected_r2 = {0};
+  const uint256_t expected_r2 = {{0}};
   mul256(&f, &val, &r2);
   assert_uint256_equal(&r2, &expected_r2);
 
-  const uint256_t expected_r3 = {0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffff60ULL};
+  const uint256_t expected_r3 = {{0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffff60ULL}};
   mul256(&u8, &val, &r3);
   assert_uint256_equal(&r3, &expected_r3);
 
-  const uint256_t expected_r4 = {0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffff5f60ULL};
+  const uint256_t expected_r4 = {{0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffff5f60ULL}};
   mul256(&u16, &val, &r4);
   assert_uint256_equal(&r4, &expected_r4);
 
-  const uint256_t expected_r5 = {0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffff5f5f5f60ULL};
+  const uint256_t expected_r5 = {{0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffff5f5f5f60ULL}};
   mul256(&u32, &val, &r5);
   assert_uint256_equal(&r5, &expected_r5);
 
-  const uint256_t expected_r6 = {0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0x5f5f5f5f5f5f5f60ULL};
+  const uint256_t expected_r6 = {{0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0x5f5f5f5f5f5f5f60ULL}};
   mul256(&u64, &val, &r6);
   assert_uint256_equal(&r6, &expected_r6);
 
-  const uint256_t expected_r7 = {0xffffffffffffffffULL, 0xffffffffffffffffULL, 0x5f5f5f5f5f5f5f5fULL, 0x5f5f5f5f5f5f5f60ULL};
+  const uint256_t expected_r7 = {{0xffffffffffffffffULL, 0xffffffffffffffffULL, 0x5f5f5f5f5f5f5f5fULL, 0x5f5f5f5f5f5f5f60ULL}};
   mul256(&u128, &val, &r7);
   assert_uint256_equal(&r7, &expected_r7);
 }
 
+static void test_shift_across_limbs(void **state) {
+  (void) state;
+
+  const uint256_t one = {{0, 0, 0, 1}};
+  const uint256_t top = {{0x8000000000000000ULL, 0, 0, 0}};
+  const uint256_t zero = {{0}};
+  uint256_t r;
+
+  for (uint32_t i = 0; i < 256; i++) {
+    uint256_t expected = {{0}};
+    expected.elements[3 - i / 64] = 1ULL << (i % 64);
+    shiftl256(&one, i, &r);
+    assert_uint256_equal(&r, &expected);
+    shiftr256(&top, 255 - i, &r);
+    assert_uint256_equal(&r, &expected);
+  }
+
+  shiftl256(&one, 256, &r);
+  assert_uint256_equal(&r, &zero);
+  shiftr256(&top, 256, &r);
+  assert_uint256_equal(&r, &zero);
+
+  const uint256_t val = {{0x0123456789abcdefULL, 0xfedcba9876543210ULL, 0x0f0f0f0f0f0f0f0fULL, 0xf0f0f0f0f0f0f0f0ULL}};
+  const uint256_t expected_l72 = {{0xdcba98765432100fULL, 0x0f0f0f0f0f0f0ff0ULL, 0xf0f0f0f0f0f0f000ULL, 0}};
+  shiftl256(&val, 72, &r);
+  assert_uint256_equal(&r, &expected_l72);
+  const uint256_t expected_r136 = {{0, 0, 0x000123456789abcdULL, 0xeffedcba98765432ULL}};
+  shiftr256(&val, 136, &r);
+  assert_uint256_equal(&r, &expected_r136);
+}
+
+static void test_bits(void **state) {
+  (void) state;
+
+  const uint256_t zero = {{0}};
+  const uint256_t max = {{0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL}};
+  const uint256_t one = {{0, 0, 0, 1}};
+  uint256_t r;
+
+  assert_int_equal(bits256(&zero), 0);
+  assert_int_equal(bits256(&max), 256);
+  for (uint32_t i = 0; i < 256; i++) {
+    shiftl256(&one, i, &r);
+    assert_int_equal(bits256(&r), i + 1);
+  }
+
+  const uint128_t zero128 = {{0, 0}};
+  const uint128_t low = {{0, 0x10}};
+  const uint128_t high = {{0x10, 0}};
+  assert_int_equal(bits128(&zero128), 0);
+  assert_int_equal(bits128(&low), 5);
+  assert_int_equal(bits128(&high), 69);
+}
+
+static void test_add_sub_carry(void **state) {
+  (void) state;
+
+  const uint256_t max = {{0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL}};
+  const uint256_t one = {{0, 0, 0, 1}};
+  const uint256_t zero = {{0}};
+  const uint256_t limb = {{0, 0, 0xffffffffffffffffULL, 0xffffffffffffffffULL}};
+  const uint256_t expected_limb = {{0, 1, 0, 0}};
+  uint256_t r;
+
+  add256(&max, &one, &r);
+  assert_uint256_equal(&r, &zero);
+  minus256(&zero, &one, &r);
+  assert_uint256_equal(&r, &max);
+  add256(&limb, &one, &r);
+  assert_uint256_equal(&r, &expected_limb);
+  minus256(&expected_limb, &one, &r);
+  assert_uint256_equal(&r, &limb);
+}
+
+static void test_divmod_tostring(void **state) {
+  (void) state;
+
+  const uint256_t max = {{0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL}};
+  const uint256_t wei = {{0, 0, 0, 1000000000000000000ULL}};
+  uint256_t l, r, div, mod;
+  char out[100];
+
+  assert_true(tostring256(&max, 10, out, sizeof(out)));
+  assert_string_equal(out, "115792089237316195423570985008687907853269984665640564039457584007913129639935");
+  assert_true(tostring256(&max, 16, out, sizeof(out)));
+  assert_string_equal(out, "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+
+  copy256(&l, &max);
+  copy256(&r, &wei);
+  divmod256(&l, &r, &div, &mod);
+  assert_true(tostring256(&div, 10, out, sizeof(out)));
+  assert_string_equal(out, "115792089237316195423570985008687907853269984665640564039457");
+  assert_true(tostring256(&mod, 10, out, sizeof(out)));
+  assert_string_equal(out, "584007913129639935");
+}
+
+static void test_small_fast_path(void **state) {
+  (void) state;
+
+  uint128_t product;
+  char out[100];
+
+  assert_true(tostring64(0, 10, out, sizeof(out)));
+  assert_string_equal(out, "0");
+  assert_true(tostring64(0xffffffffffffffffULL, 10, out, sizeof(out)));
+  assert_string_equal(out, "18446744073709551615");
+  assert_true(tostring64(0xdeadbeefULL, 16, out, sizeof(out)));
+  assert_string_equal(out, "deadbeef");
+  assert_false(tostring64(1000, 10, out, 4));
+
+  // 21000 gas at 5 gwei
+  mul64(21000, 5000000000ULL, &product);
+  assert_true(tostring128(&product, 10, out, sizeof(out)));
+  assert_string_equal(out, "105000000000000");
+
+  mul64(0xffffffffffffffffULL, 0xffffffffffffffffULL, &product);
+  assert_int_equal(UPPER(product), 0xfffffffffffffffeULL);
+  assert_int_equal(LOWER(product), 1);
+  assert_true(tostring128(&product, 10, out, sizeof(out)));
+  assert_string_equal(out, "340282366920938463426481119284349108225");
+  assert_true(tostring128(&product, 16, out, sizeof(out)));
+  assert_string_equal(out, "fffffffffffffffe0000000000000001");
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
       cmocka_unit_test(test_bitshift_right),
@@ -251,6 +375,11 @@ int main(void) {
       cmocka_unit_test(test_external_shift_left),
       cmocka_unit_test(test_arithmetic_multiply),
       cmocka_unit_test(test_external_multiply),
+      cmocka_unit_test(test_shift_across_limbs),
+      cmocka_unit_test(test_bits),
+      cmocka_unit_test(test_add_sub_carry),
+      cmocka_unit_test(test_divmod_tostring),
+      cmocka_unit_test(test_small_fast_path),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
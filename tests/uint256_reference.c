@@ -0,0 +1,45 @@
+// Reference build of uint256.c, see uint256_reference.h
+
+// Kernels selected at compile time never apply to the reference
+#undef UINT256_FAST_DIVISION
+#undef UINT256_STATS
+
+// Included before the renaming so that uint256.h keeps its own names
+#include "uint256_reference.h"
+
+#define readu128BE ref_readu128BE
+#define readu256BE ref_readu256BE
+#define zero128 ref_zero128
+#define zero256 ref_zero256
+#define copy128 ref_copy128
+#define copy256 ref_copy256
+#define clear128 ref_clear128
+#define clear256 ref_clear256
+#define shiftl128 ref_shiftl128
+#define shiftr128 ref_shiftr128
+#define shiftl256 ref_shiftl256
+#define shiftr256 ref_shiftr256
+#define bits128 ref_bits128
+#define bits256 ref_bits256
+#define equal128 ref_equal128
+#define equal256 ref_equal256
+#define gt128 ref_gt128
+#define gt256 ref_gt256
+#define gte128 ref_gte128
+#define gte256 ref_gte256
+#define add128 ref_add128
+#define add256 ref_add256
+#define minus128 ref_minus128
+#define minus256 ref_minus256
+#define or128 ref_or128
+#define or256 ref_or256
+#define mul64 ref_mul64
+#define mul128 ref_mul128
+#define mul256 ref_mul256
+#define divmod128 ref_divmod128
+#define divmod256 ref_divmod256
+#define tostring64 ref_tostring64
+#define tostring128 ref_tostring128
+#define tostring256 ref_tostring256
+
+#include "uint256.c"
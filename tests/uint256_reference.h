@@ -0,0 +1,45 @@
+// Reference build of uint256.c, compiled with none of the optional kernels
+// and with every public function prefixed by ref_. Used by the differential
+// oracle to check the kernels selected at compile time.
+
+#ifndef _UINT256_REFERENCE_H_
+#define _UINT256_REFERENCE_H_
+
+#include "uint256.h"
+
+void ref_readu128BE(const uint8_t *buffer, uint128_t *target);
+void ref_readu256BE(const uint8_t *buffer, uint256_t *target);
+bool ref_zero128(const uint128_t *number);
+bool ref_zero256(const uint256_t *number);
+void ref_copy128(uint128_t *target, const uint128_t *number);
+void ref_copy256(uint256_t *target, const uint256_t *number);
+void ref_clear128(uint128_t *target);
+void ref_clear256(uint256_t *target);
+void ref_shiftl128(const uint128_t *number, uint32_t value, uint128_t *target);
+void ref_shiftr128(const uint128_t *number, uint32_t value, uint128_t *target);
+void ref_shiftl256(const uint256_t *number, uint32_t value, uint256_t *target);
+void ref_shiftr256(const uint256_t *number, uint32_t value, uint256_t *target);
+uint32_t ref_bits128(const uint128_t *number);
+uint32_t ref_bits256(const uint256_t *number);
+bool ref_equal128(const uint128_t *number1, const uint128_t *number2);
+bool ref_equal256(const uint256_t *number1, const uint256_t *number2);
+bool ref_gt128(const uint128_t *number1, const uint128_t *number2);
+bool ref_gt256(const uint256_t *number1, const uint256_t *number2);
+bool ref_gte128(const uint128_t *number1, const uint128_t *number2);
+bool ref_gte256(const uint256_t *number1, const uint256_t *number2);
+void ref_add128(const uint128_t *number1, const uint128_t *number2, uint128_t *target);
+void ref_add256(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
+void ref_minus128(const uint128_t *number1, const uint128_t *number2, uint128_t *target);
+void ref_minus256(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
+void ref_or128(const uint128_t *number1, const uint128_t *number2, uint128_t *target);
+void ref_or256(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
+void ref_mul64(uint64_t number1, uint64_t number2, uint128_t *target);
+void ref_mul128(const uint128_t *number1, const uint128_t *number2, uint128_t *target);
+void ref_mul256(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
+void ref_divmod128(uint128_t *l, uint128_t *r, uint128_t *div, uint128_t *mod);
+void ref_divmod256(uint256_t *l, uint256_t *r, uint256_t *div, uint256_t *mod);
+bool ref_tostring64(uint64_t number, uint32_t base, char *out, uint32_t outLength);
+bool ref_tostring128(const uint128_t *number, uint32_t base, char *out, uint32_t outLength);
+bool ref_tostring256(const uint256_t *number, uint32_t base, char *out, uint32_t outLength);
+
+#endif // _UINT256_REFERENCE_H_
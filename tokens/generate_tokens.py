@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""
+Generates src_common/tokensTable.h from the tokens manifest.
+
+The tokens are indexed by a perfect hash of their address: the 4 address
+bytes at TOKENS_HASH_OFFSET, read little endian, are multiplied by
+TOKENS_HASH_MULTIPLIER and the top TOKENS_HASH_BITS bits of the 32 bits
+product select a slot. The generator searches the offset and multiplier for
+which no two tokens share a slot.
+"""
+from __future__ import print_function
+
+import argparse
+import json
+import sys
+
+TICKER_LENGTH = 10
+MAX_BITS = 8
+
+
+def slot(address, offset, multiplier, bits):
+    word = int.from_bytes(address[offset:offset + 4], "little")
+    return ((word * multiplier) & 0xffffffff) >> (32 - bits)
+
+
+def find_hash(addresses):
+    bits = max(1, (len(addresses) - 1).bit_length())
+    while bits <= MAX_BITS:
+        for offset in range(0, 17):
+            # Odd multipliers, deterministic so the output is reproducible
+            for multiplier in range(1, 1 << 16, 2):
+                multiplier = (multiplier * 0x9e3779b1) & 0xffffffff | 1
+                slots = set(slot(address, offset, multiplier, bits) for address in addresses)
+                if len(slots) == len(addresses):
+                    return offset, multiplier, bits
+        bits += 1
+    raise ValueError("No perfect hash found")
+
+
+def parse_manifest(path):
+    with open(path) as f:
+        manifest = json.load(f)
+    tokens = []
+    for token in manifest["tokens"]:
+        address = bytes.fromhex(token["address"][2:])
+        ticker = token["ticker"] + " "
+        if len(address) != 20:
+            raise ValueError("Invalid address for " + token["ticker"])
+        # Room for the ticker, its trailing space and the terminating zero
+        if len(ticker) + 1 > TICKER_LENGTH:
+            raise ValueError("Ticker too long: " + token["ticker"])
+        if not 0 <= token["decimals"] <= 255:
+            raise ValueError("Invalid decimals for " + token["ticker"])
+        tokens.append((ticker, address, token["decimals"]))
+    if len(set(address for _, address, _ in tokens)) != len(tokens):
+        raise ValueError("Duplicate token address")
+    return tokens
+
+
+def generate(tokens):
+    offset, multiplier, bits = find_hash([address for _, address, _ in tokens])
+    slots = [0] * (1 << bits)
+    for index, (_, address, _) in enumerate(tokens):
+        slots[slot(address, offset, multiplier, bits)] = index + 1
+    lines = [
+        "// Generated by tokens/generate_tokens.py from tokens/tokens.json, do not edit",
+        "",
+        "#define TOKENS_COUNT %d" % len(tokens),
+        "#define TOKENS_HASH_OFFSET %d" % offset,
+        "#define TOKENS_HASH_MULTIPLIER 0x%08xu" % multiplier,
+        "#define TOKENS_HASH_BITS %d" % bits,
+        "",
+        "static const tokenDefinition_t TOKENS_LIST[TOKENS_COUNT] = {",
+    ]
+    for ticker, address, decimals in tokens:
+        lines.append("    { { %s }, \"%s\", %d }," % (
+            ", ".join("0x%02x" % b for b in address), ticker, decimals))
+    lines += [
+        "};",
+        "",
+        "// Index in TOKENS_LIST plus one of each slot, 0 when empty",
+        "static const uint8_t TOKENS_SLOTS[1 << TOKENS_HASH_BITS] = { %s };" % ", ".join(str(s) for s in slots),
+        "",
+    ]
+    return "\n".join(lines)
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('manifest', help="Tokens manifest")
+parser.add_argument('--output', help="Generated header (default : standard output)")
+parser.add_argument('--check', help="Fail if the output header is not up to date", action='store_true')
+args = parser.parse_args()
+
+header = generate(parse_manifest(args.manifest))
+if args.check:
+    with open(args.output) as f:
+        if f.read() != header:
+            sys.exit(args.output + " is out of date, regenerate it from " + args.manifest)
+elif args.output is None:
+    sys.stdout.write(header)
+else:
+    with open(args.output, "w") as f:
+        f.write(header)